@@ -0,0 +1,211 @@
+// File: batch.cpp
+// --------------------------------------------------------
+// Class: CS 470                      Instructor: Dr. Hwang
+// Assignment: Process Scheduling     Date Assigned: 22 February 2016
+// Programmer: Evan Higgins           Date Completed: 18 March 2016
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+#include <dirent.h>
+#include <sys/stat.h>
+#include "batch.hpp"
+#include "input_reader.hpp"
+#include "parallel.hpp"
+
+using namespace std;
+
+namespace {
+
+// ============================================================
+//
+// The parsed commands of one batch input. They are loaded by
+// whichever job gets to the input first and dropped after its
+// last job, so a batch of thousands of traces only holds the
+// ones in flight.
+//
+// ============================================================
+struct BatchInput
+{
+    once_flag loaded;
+    unique_ptr<CommandBuffer> commands;
+    atomic<size_t> jobs_left;
+};
+
+bool is_regular_file(const string & path) {
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 && S_ISREG(info.st_mode);
+}
+
+string join_path(const string & directory, const string & name) {
+    if(directory.empty() || directory.back() == '/')
+        return directory + name;
+    return directory + "/" + name;
+}
+
+}
+
+// ============================================================
+// Function: batch_output_name(const string&, const string&, int)
+// Returns:  string
+//
+// Names the output for input run with quantum in output_dir:
+// the input's file name with "-q" and the quantum added before
+// its extension.
+// ============================================================
+string batch_output_name(const string & output_dir, const string & input, int quantum) {
+    size_t slash = input.find_last_of('/');
+    string name = slash == string::npos ? input : input.substr(slash + 1);
+
+    size_t dot = name.find_last_of('.');
+    if(dot == string::npos || dot == 0)
+        dot = name.size();
+    name.insert(dot, "-q" + to_string(quantum));
+
+    return join_path(output_dir, name);
+}
+
+// ============================================================
+// Function: read_batch_manifest(const string&, const string&,
+//                               vector<BatchJob>&)
+// Returns:  bool
+//
+// Adds the jobs listed in a manifest to jobs. Returns false if
+// the manifest can't be read or has a malformed line.
+// ============================================================
+bool read_batch_manifest(const string & manifest,
+                         const string & output_dir,
+                         vector<BatchJob> & jobs) {
+    ifstream file(manifest);
+    if(!file) {
+        cerr << "[ERROR]: Manifest " << manifest << " did not open correctly." << endl;
+        return false;
+    }
+
+    string line;
+    for(int line_number = 1; getline(file, line); ++line_number) {
+        istringstream fields(line);
+        BatchJob job;
+        if(!(fields >> job.input) || job.input[0] == '#')
+            continue;
+
+        string quantum, extra;
+        if(!(fields >> quantum) ||
+                !parse_int(quantum.data(), quantum.data() + quantum.size(), job.quantum) ||
+                ((fields >> job.output) && (fields >> extra))) {
+            cerr << "[ERROR]: Malformed manifest line " << line_number << ": " << line << endl;
+            return false;
+        }
+
+        if(job.output.empty())
+            job.output = batch_output_name(output_dir, job.input, job.quantum);
+        jobs.push_back(job);
+    }
+    return true;
+}
+
+// ============================================================
+// Function: read_batch_directory(const string&,
+//                                const vector<int>&,
+//                                const string&,
+//                                vector<BatchJob>&)
+// Returns:  bool
+//
+// Adds a job for every regular file in directory and every
+// quantum in quanta, sorted by file name so a run always lists
+// its jobs the same way. Returns false if the directory can't
+// be read.
+// ============================================================
+bool read_batch_directory(const string & directory,
+                          const vector<int> & quanta,
+                          const string & output_dir,
+                          vector<BatchJob> & jobs) {
+    DIR * listing = opendir(directory.c_str());
+    if(!listing) {
+        cerr << "[ERROR]: Directory " << directory << " did not open correctly." << endl;
+        return false;
+    }
+
+    vector<string> inputs;
+    while(dirent * entry = readdir(listing)) {
+        string path = join_path(directory, entry->d_name);
+        if(is_regular_file(path))
+            inputs.push_back(path);
+    }
+    closedir(listing);
+    sort(inputs.begin(), inputs.end());
+
+    for(auto & input : inputs)
+        for(int quantum : quanta)
+            jobs.push_back(BatchJob{input, quantum,
+                                    batch_output_name(output_dir, input, quantum)});
+    return true;
+}
+
+// ============================================================
+// Function: run_batch(const vector<BatchJob>&,
+//                     const RunOptions&, unsigned)
+// Returns:  bool
+//
+// Runs every job on up to threads threads and reports the
+// throughput on stdout. Each input is parsed once no matter
+// how many jobs use it. A job whose input or output can't be
+// opened fails on its own without stopping the batch. Returns
+// false if any job failed.
+// ============================================================
+bool run_batch(const vector<BatchJob> & jobs,
+               const RunOptions & options,
+               unsigned threads) {
+    auto start = chrono::steady_clock::now();
+
+    //Jobs share one BatchInput per distinct input file.
+    unordered_map<string, size_t> input_index;
+    vector<unique_ptr<BatchInput>> inputs;
+    vector<size_t> job_input(jobs.size());
+    for(size_t i = 0; i < jobs.size(); ++i) {
+        auto found = input_index.find(jobs[i].input);
+        if(found == input_index.end()) {
+            found = input_index.emplace(jobs[i].input, inputs.size()).first;
+            inputs.emplace_back(new BatchInput());
+            inputs.back()->jobs_left = 0;
+        }
+        job_input[i] = found->second;
+        ++inputs[found->second]->jobs_left;
+    }
+
+    atomic<size_t> failed(0);
+    parallel_for(jobs.size(), threads, [&](size_t i) {
+                const BatchJob & job = jobs[i];
+                BatchInput & input = *inputs[job_input[i]];
+
+                call_once(input.loaded, [&]() {
+                            InputReader reader(job.input);
+                            if(reader.good())
+                                input.commands.reset(new CommandBuffer(reader));
+                            else
+                                cerr << ("[ERROR]: Input file " + job.input +
+                                         " did not open correctly.\n");
+                        });
+
+                if(!input.commands ||
+                        !simulate(job.quantum, *input.commands, job.output, options))
+                    ++failed;
+
+                if(--input.jobs_left == 0)
+                    input.commands.reset();
+            });
+
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    cout << "Batch: " << jobs.size() << " jobs, " << failed << " failed, "
+         << elapsed.count() << " s, "
+         << (elapsed.count() > 0 ? jobs.size() / elapsed.count() : 0)
+         << " jobs/sec" << endl;
+
+    return failed == 0;
+}
@@ -0,0 +1,53 @@
+// File: batch.hpp
+// --------------------------------------------------------
+// Class: CS 470                      Instructor: Dr. Hwang
+// Assignment: Process Scheduling     Date Assigned: 22 February 2016
+// Programmer: Evan Higgins           Date Completed: 18 March 2016
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <string>
+#include <vector>
+#include "simulation.hpp"
+
+// ============================================================
+//
+// One simulation in a batch: an input file run with one
+// quantum and written to one output file.
+//
+// ============================================================
+struct BatchJob
+{
+    std::string input;
+    int quantum;
+    std::string output;
+};
+
+// ============================================================
+//
+// A batch is read from a manifest or from a directory of
+// traces. A manifest has one job per line:
+//
+//     input_file quantum [output_file]
+//
+// Blank lines and lines starting with # are skipped. Without
+// an output file, or for every file of a directory, the output
+// goes to output_dir and is named after the input with -q and
+// the quantum added, so test1.dat at quantum 5 is written to
+// output_dir/test1-q5.dat like the files in output/.
+//
+// ============================================================
+bool read_batch_manifest(const std::string&,
+                         const std::string&,
+                         std::vector<BatchJob>&);
+bool read_batch_directory(const std::string&,
+                          const std::vector<int>&,
+                          const std::string&,
+                          std::vector<BatchJob>&);
+
+std::string batch_output_name(const std::string&, const std::string&, int);
+
+bool run_batch(const std::vector<BatchJob>&, const RunOptions&, unsigned);
+
+#endif //BATCH_H
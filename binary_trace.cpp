@@ -0,0 +1,264 @@
+// File: binary_trace.cpp
+// --------------------------------------------------------
+// Class: CS 470                      Instructor: Dr. Hwang
+// Assignment: Process Scheduling     Date Assigned: 22 February 2016
+// Programmer: Evan Higgins           Date Completed: 18 March 2016
+
+#include <cstdint>
+#include <cstring>
+#include "binary_trace.hpp"
+
+using namespace std;
+
+// ============================================================
+// Function: append_varint(string&, uint64_t)
+//
+// Appends value as an unsigned LEB128 varint: 7 bits per byte,
+// low bits first, with the high bit set on all but the last
+// byte.
+// ============================================================
+void append_varint(string & out, uint64_t value) {
+    while(value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+// ============================================================
+// Function: read_varint(const char*&, const char*, uint64_t&)
+// Returns:  bool
+//
+// Reads a varint at cursor and advances past it. Returns false
+// if the varint runs past end.
+// ============================================================
+bool read_varint(const char *& cursor, const char * end, uint64_t & value) {
+    value = 0;
+    for(int shift = 0; cursor != end && shift < 64; shift += 7) {
+        uint8_t byte = static_cast<uint8_t>(*cursor++);
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if(!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+namespace {
+
+bool read_int(const char *& cursor, const char * end, int & value) {
+    uint64_t result;
+    if(!read_varint(cursor, end, result) || result > INT32_MAX)
+        return false;
+    value = static_cast<int>(result);
+    return true;
+}
+
+char opcode_for(const Command & command) {
+    switch(command.type) {
+    case CommandType::Create:
+        if(command.args[3] != 0)
+            return 'B';
+        return command.args[2] == 0 ? 'C' : 'P';
+    case CommandType::Destroy: return 'D';
+    case CommandType::Wait:    return command.args[1] == 0 ? 'W' : 'O';
+    case CommandType::Event:
+        return command.extra_events == 0 && !command.broadcast ? 'E' : 'M';
+    case CommandType::Idle:    return command.args[0] == 1 ? 'I' : 'N';
+    case CommandType::Exit:    return 'X';
+    }
+    return 'R';
+}
+
+}
+
+// ============================================================
+// Function: is_binary_trace(const char*, size_t)
+// Returns:  bool
+//
+// Returns true if data starts with a binary trace header of a
+// version this build understands. Every earlier version is a
+// subset of the current one.
+// ============================================================
+bool is_binary_trace(const char * data, size_t size) {
+    if(size < TRACE_HEADER_SIZE || memcmp(data, TRACE_MAGIC, TRACE_MAGIC_SIZE) != 0)
+        return false;
+
+    const uint8_t * bytes = reinterpret_cast<const uint8_t*>(data + TRACE_MAGIC_SIZE);
+    uint32_t version = bytes[0] | bytes[1] << 8 | bytes[2] << 16 |
+                       static_cast<uint32_t>(bytes[3]) << 24;
+    return version >= 1 && version <= TRACE_VERSION;
+}
+
+void append_trace_header(string & out) {
+    out.append(TRACE_MAGIC, TRACE_MAGIC_SIZE);
+    out.push_back(TRACE_VERSION & 0xFF);
+    out.append(3, '\0');
+    out.append(4, '\0');
+}
+
+// ============================================================
+// Function: append_trace_record(string&, const char*, size_t)
+//
+// Encodes one line of text input as a record.
+// ============================================================
+void append_trace_record(string & out, const char * line, size_t length) {
+    Command command;
+    char text[COMMAND_TEXT_MAX];
+    if(!parse_command(line, length, command) ||
+            format_command(command, text) != length ||
+            memcmp(text, line, length) != 0) {
+        out.push_back('R');
+        append_varint(out, length);
+        out.append(line, length);
+        return;
+    }
+
+    out.push_back(opcode_for(command));
+    switch(command.type) {
+    case CommandType::Create:
+        append_varint(out, command.args[0]);
+        if(command.args[3] != 0) {
+            append_varint(out, command.args[3]);
+            append_varint(out, command.args[1]);
+            append_varint(out, command.args[2]);
+            break;
+        }
+        append_varint(out, command.args[1]);
+        if(command.args[2] != 0)
+            append_varint(out, command.args[2]);
+        break;
+    case CommandType::Destroy:
+        append_varint(out, command.args[0]);
+        break;
+    case CommandType::Wait:
+        append_varint(out, command.args[0]);
+        if(command.args[1] != 0)
+            append_varint(out, command.args[1]);
+        break;
+    case CommandType::Event:
+        if(opcode_for(command) == 'M')
+            append_varint(out, command.extra_events << 1 | command.broadcast);
+        for(int i = 0; i <= command.extra_events; ++i)
+            append_varint(out, command.args[i]);
+        break;
+    case CommandType::Idle:
+        if(command.args[0] != 1)
+            append_varint(out, command.args[0]);
+        break;
+    case CommandType::Exit:
+        break;
+    }
+}
+
+// ============================================================
+// Function: read_trace_record(const char*&, const char*,
+//                             InputLine&, char*)
+// Returns:  TraceStatus
+//
+// Decodes the record at cursor and advances past it. Opcode
+// records are decoded straight into line.command and their
+// canonical text is written to text, which must hold
+// COMMAND_TEXT_MAX chars. Raw records point line.text into
+// the trace itself and are left for the parser.
+// ============================================================
+TraceStatus read_trace_record(const char *& cursor,
+                              const char * end,
+                              InputLine & line,
+                              char * text) {
+    if(cursor == end)
+        return TraceStatus::End;
+
+    Command & command = line.command;
+    char opcode = *cursor++;
+    bool valid = true;
+    switch(opcode) {
+    case 'C':
+        command.type = CommandType::Create;
+        command.args[2] = 0;
+        command.args[3] = 0;
+        valid = read_int(cursor, end, command.args[0]) &&
+                read_int(cursor, end, command.args[1]);
+        break;
+    case 'P':
+        command.type = CommandType::Create;
+        command.args[3] = 0;
+        valid = read_int(cursor, end, command.args[0]) &&
+                read_int(cursor, end, command.args[1]) &&
+                read_int(cursor, end, command.args[2]);
+        break;
+    case 'B':
+        command.type = CommandType::Create;
+        valid = read_int(cursor, end, command.args[0]) &&
+                read_int(cursor, end, command.args[3]) &&
+                read_int(cursor, end, command.args[1]) &&
+                read_int(cursor, end, command.args[2]) &&
+                command.args[3] >= 1 && command.args[3] <= CREATE_BULK_MAX &&
+                command.args[3] - 1 <= INT32_MAX - command.args[0];
+        break;
+    case 'D':
+        command.type = CommandType::Destroy;
+        valid = read_int(cursor, end, command.args[0]);
+        break;
+    case 'W':
+        command.type = CommandType::Wait;
+        command.args[1] = 0;
+        valid = read_int(cursor, end, command.args[0]);
+        break;
+    case 'O':
+        command.type = CommandType::Wait;
+        valid = read_int(cursor, end, command.args[0]) &&
+                read_int(cursor, end, command.args[1]) && command.args[1] >= 1;
+        break;
+    case 'E':
+        command.type = CommandType::Event;
+        command.extra_events = 0;
+        command.broadcast = false;
+        valid = read_int(cursor, end, command.args[0]);
+        break;
+    case 'M': {
+        uint64_t form;
+        valid = read_varint(cursor, end, form) &&
+                (form >> 1) < COMMAND_EVENTS_MAX;
+        if(!valid)
+            break;
+        command.type = CommandType::Event;
+        command.extra_events = form >> 1;
+        command.broadcast = form & 1;
+        for(int i = 0; valid && i <= command.extra_events; ++i)
+            valid = read_int(cursor, end, command.args[i]);
+        break;
+    }
+    case 'I':
+        command.type = CommandType::Idle;
+        command.args[0] = 1;
+        break;
+    case 'N':
+        command.type = CommandType::Idle;
+        valid = read_int(cursor, end, command.args[0]) && command.args[0] >= 1;
+        break;
+    case 'X':
+        command.type = CommandType::Exit;
+        break;
+    case 'R': {
+        uint64_t length;
+        if(!read_varint(cursor, end, length) ||
+                length > static_cast<uint64_t>(end - cursor))
+            return TraceStatus::Corrupt;
+        line.text = cursor;
+        line.length = length;
+        line.decoded = false;
+        cursor += length;
+        return TraceStatus::Record;
+    }
+    default:
+        return TraceStatus::Corrupt;
+    }
+
+    if(!valid)
+        return TraceStatus::Corrupt;
+
+    line.text = text;
+    line.length = format_command(command, text);
+    line.decoded = true;
+    return TraceStatus::Record;
+}
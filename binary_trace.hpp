@@ -0,0 +1,72 @@
+// File: binary_trace.hpp
+// --------------------------------------------------------
+// Class: CS 470                      Instructor: Dr. Hwang
+// Assignment: Process Scheduling     Date Assigned: 22 February 2016
+// Programmer: Evan Higgins           Date Completed: 18 March 2016
+
+#ifndef BINARY_TRACE_H
+#define BINARY_TRACE_H
+
+#include <cstdint>
+#include <string>
+#include "command.hpp"
+
+// ============================================================
+//
+// Binary command trace format, version 4.
+//
+// A trace starts with a 16 byte header:
+//  bytes 0-7    magic "SCHEDBIN"
+//  bytes 8-11   format version, little endian
+//  bytes 12-15  reserved, zero
+//
+// followed by one record per input line. A record is an opcode
+// byte and its operands, each operand an unsigned LEB128
+// varint:
+//  'C' pid burst
+//  'P' pid burst priority, for a C with a priority
+//  'B' pid count burst priority, for a C*
+//  'D' pid
+//  'W' event_id
+//  'O' event_id timeout, for a W with a timeout
+//  'E' event_id
+//  'M' form, then event ids, for any other E: form is twice
+//      the number of event ids after the first, plus 1 for E*
+//  'I'
+//  'N' ticks, for an I of more than one tick
+//  'X'
+//  'R' length, then length bytes of raw line text
+//
+// Lines whose canonical text (see format_command) is exactly
+// the original line are stored as opcodes. Anything else,
+// including invalid commands and lines with unusual spacing,
+// is stored as a raw record so the text form can always be
+// reproduced byte for byte. Earlier versions are still read:
+// version 1 had no 'M' records, version 2 no 'O' records and
+// version 3 no 'B' records.
+//
+// ============================================================
+
+#define TRACE_MAGIC "SCHEDBIN"
+#define TRACE_MAGIC_SIZE 8
+#define TRACE_VERSION 4
+#define TRACE_HEADER_SIZE 16
+
+enum class TraceStatus
+{
+    Record,
+    End,
+    Corrupt
+};
+
+void append_varint(std::string&, uint64_t);
+bool read_varint(const char*&, const char*, uint64_t&);
+
+bool is_binary_trace(const char*, size_t);
+
+void append_trace_header(std::string&);
+void append_trace_record(std::string&, const char*, size_t);
+
+TraceStatus read_trace_record(const char*&, const char*, InputLine&, char*);
+
+#endif //BINARY_TRACE_H
@@ -0,0 +1,266 @@
+// File: command.cpp
+// --------------------------------------------------------
+// Class: CS 470                      Instructor: Dr. Hwang
+// Assignment: Process Scheduling     Date Assigned: 22 February 2016
+// Programmer: Evan Higgins           Date Completed: 18 March 2016
+
+#include <climits>
+#include "command.hpp"
+
+//Commands never need more than this many tokens. Any extra
+//tokens are only counted.
+#define MAX_TOKENS (1 + COMMAND_EVENTS_MAX)
+
+static_assert(COMMAND_TEXT_MAX >=
+              2 + sizeof(Command().args) / sizeof(int) * (1 + COMMAND_INT_DIGITS) + 1,
+              "COMMAND_TEXT_MAX must hold every operand format_command can write");
+
+namespace {
+
+struct Token
+{
+    const char * begin;
+    const char * end;
+};
+
+//Matches the characters std::isspace treats as whitespace in
+//the "C" locale, which is what the input has always been split
+//on.
+inline bool is_space(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+char * format_int(int value, char * out) {
+    char digits[16];
+    char * begin = digits + sizeof(digits);
+    unsigned magnitude = value;
+    do {
+        *--begin = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while(magnitude != 0);
+
+    while(begin != digits + sizeof(digits))
+        *out++ = *begin++;
+    return out;
+}
+
+bool parse_events(const Token * tokens, size_t token_count,
+                  bool broadcast, Command & command) {
+    if(token_count < 2 || token_count > MAX_TOKENS)
+        return false;
+
+    command.type = CommandType::Event;
+    command.extra_events = token_count - 2;
+    command.broadcast = broadcast;
+    for(size_t i = 1; i < token_count; ++i)
+        if(!parse_int(tokens[i].begin, tokens[i].end, command.args[i - 1]))
+            return false;
+    return true;
+}
+
+//The PIDs of a C* have to fit in an int as well.
+bool parse_bulk_create(const Token * tokens, size_t token_count, Command & command) {
+    command.type = CommandType::Create;
+    command.args[2] = 0;
+    return (token_count == 4 || token_count == 5) &&
+           parse_int(tokens[1].begin, tokens[1].end, command.args[0]) &&
+           parse_int(tokens[2].begin, tokens[2].end, command.args[3]) &&
+           parse_int(tokens[3].begin, tokens[3].end, command.args[1]) &&
+           (token_count == 4 ||
+            parse_int(tokens[4].begin, tokens[4].end, command.args[2])) &&
+           command.args[3] >= 1 && command.args[3] <= CREATE_BULK_MAX &&
+           command.args[3] - 1 <= INT_MAX - command.args[0];
+}
+
+}
+
+// ============================================================
+// Function: parse_int(const char*, const char*, int&)
+// Returns:  bool
+//
+// Validates and converts [begin, end) in a single pass. The
+// token must be made up entirely of digits and fit in an int.
+// ============================================================
+bool parse_int(const char * begin, const char * end, int & value) {
+    if(begin == end)
+        return false;
+
+    long long result = 0;
+    for(; begin != end; ++begin) {
+        unsigned digit = static_cast<unsigned char>(*begin) - '0';
+        if(digit > 9)
+            return false;
+        result = result * 10 + digit;
+        if(result > INT_MAX)
+            return false;
+    }
+
+    value = static_cast<int>(result);
+    return true;
+}
+
+// ============================================================
+// Function: parse_command(const char*, size_t, Command&)
+// Returns:  bool
+//
+// Tokenizes a line in place and fills in command. Returns
+// false if the line is not a well formed command. This is
+// entirely input validation, no scheduling happens here.
+//
+// Accepted forms are:
+//  C # #
+//  C # # # (with a priority, 0 if not given)
+//  C* # # # [#] (a first PID, a count from 1 to
+//          CREATE_BULK_MAX, then a burst and priority as for C.
+//          It runs one tick per process, like that many C lines
+//          with consecutive PIDs)
+//  D #
+//  W #
+//  W # #    (with a timeout in ticks, if it is at least 1)
+//  E # ...  (up to COMMAND_EVENTS_MAX events)
+//  E* # ... (the same, waking every waiter)
+//  I       (idles for one tick)
+//  I #     (idles for # ticks, if # is at least 1)
+//  X       (anything after the X is ignored)
+//
+// Anything else after an I is ignored, as it always has been,
+// and the I idles for one tick.
+// ============================================================
+bool parse_command(const char * line, size_t length, Command & command) {
+    Token tokens[MAX_TOKENS];
+    size_t token_count = 0;
+
+    const char * end = line + length;
+    for(const char * c = line; c != end;) {
+        if(is_space(*c)) {
+            ++c;
+            continue;
+        }
+
+        const char * token_begin = c;
+        while(c != end && !is_space(*c))
+            ++c;
+
+        if(token_count < MAX_TOKENS)
+            tokens[token_count] = Token{ token_begin, c };
+        ++token_count;
+    }
+
+    if(token_count == 0)
+        return false;
+
+    size_t name_length = tokens[0].end - tokens[0].begin;
+    if(name_length == 2 && tokens[0].begin[0] == 'E' && tokens[0].begin[1] == '*')
+        return parse_events(tokens, token_count, true, command);
+    if(name_length == 2 && tokens[0].begin[0] == 'C' && tokens[0].begin[1] == '*')
+        return parse_bulk_create(tokens, token_count, command);
+    if(name_length != 1)
+        return false;
+
+    switch(*tokens[0].begin) {
+    case 'C':
+        command.type = CommandType::Create;
+        command.args[2] = 0;
+        command.args[3] = 0;
+        return (token_count == 3 || token_count == 4) &&
+               parse_int(tokens[1].begin, tokens[1].end, command.args[0]) &&
+               parse_int(tokens[2].begin, tokens[2].end, command.args[1]) &&
+               (token_count == 3 ||
+                parse_int(tokens[3].begin, tokens[3].end, command.args[2]));
+    case 'D':
+        command.type = CommandType::Destroy;
+        break;
+    case 'W':
+        command.type = CommandType::Wait;
+        command.args[1] = 0;
+        return (token_count == 2 || token_count == 3) &&
+               parse_int(tokens[1].begin, tokens[1].end, command.args[0]) &&
+               (token_count == 2 ||
+                (parse_int(tokens[2].begin, tokens[2].end, command.args[1]) &&
+                 command.args[1] >= 1));
+    case 'E':
+        return parse_events(tokens, token_count, false, command);
+    case 'I':
+        command.type = CommandType::Idle;
+        if(token_count != 2 ||
+                !parse_int(tokens[1].begin, tokens[1].end, command.args[0]) ||
+                command.args[0] < 1)
+            command.args[0] = 1;
+        return true;
+    case 'X':
+        command.type = CommandType::Exit;
+        return true;
+    default:
+        return false;
+    }
+
+    //D takes exactly one integer argument
+    return token_count == 2 &&
+           parse_int(tokens[1].begin, tokens[1].end, command.args[0]);
+}
+
+// ============================================================
+// Function: format_command(const Command&, char*)
+// Returns:  size_t
+//
+// Writes the canonical text of command (single spaces, no
+// leading zeros) to out, which must hold COMMAND_TEXT_MAX
+// chars, and returns its length. Parsing the result gives
+// back the same command.
+// ============================================================
+size_t format_command(const Command & command, char * out) {
+    char * end = out;
+    switch(command.type) {
+    case CommandType::Create:
+        *end++ = 'C';
+        if(command.args[3] != 0)
+            *end++ = '*';
+        *end++ = ' ';
+        end = format_int(command.args[0], end);
+        if(command.args[3] != 0) {
+            *end++ = ' ';
+            end = format_int(command.args[3], end);
+        }
+        *end++ = ' ';
+        end = format_int(command.args[1], end);
+        if(command.args[2] != 0) {
+            *end++ = ' ';
+            end = format_int(command.args[2], end);
+        }
+        break;
+    case CommandType::Destroy:
+        *end++ = 'D';
+        *end++ = ' ';
+        end = format_int(command.args[0], end);
+        break;
+    case CommandType::Wait:
+        *end++ = 'W';
+        *end++ = ' ';
+        end = format_int(command.args[0], end);
+        if(command.args[1] != 0) {
+            *end++ = ' ';
+            end = format_int(command.args[1], end);
+        }
+        break;
+    case CommandType::Event:
+        *end++ = 'E';
+        if(command.broadcast)
+            *end++ = '*';
+        for(int i = 0; i <= command.extra_events; ++i) {
+            *end++ = ' ';
+            end = format_int(command.args[i], end);
+        }
+        break;
+    case CommandType::Idle:
+        *end++ = 'I';
+        if(command.args[0] != 1) {
+            *end++ = ' ';
+            end = format_int(command.args[0], end);
+        }
+        break;
+    case CommandType::Exit:
+        *end++ = 'X';
+        break;
+    }
+    return end - out;
+}
@@ -0,0 +1,94 @@
+// File: command.hpp
+// --------------------------------------------------------
+// Class: CS 470                      Instructor: Dr. Hwang
+// Assignment: Process Scheduling     Date Assigned: 22 February 2016
+// Programmer: Evan Higgins           Date Completed: 18 March 2016
+
+#ifndef COMMAND_H
+#define COMMAND_H
+
+#include <cstddef>
+
+enum class CommandType
+{
+    Create,     // C pid burst [priority], or C* first_pid count burst [priority]
+    Destroy,    // D pid
+    Idle,       // I [ticks]
+    Wait,       // W event_id [timeout]
+    Event,      // E event_id..., or E* event_id... to wake every waiter
+    Exit        // X
+};
+
+//Most event ids a single E can name.
+#define COMMAND_EVENTS_MAX 8
+
+//Most processes a single C* can create.
+#define CREATE_BULK_MAX (1 << 20)
+
+// ============================================================
+//
+// A decoded input command. Commands are small and trivially
+// copyable so they can be parsed straight out of the input
+// buffer without allocating.
+//
+// An E keeps its event ids in args, with extra_events counting
+// those after the first. Both extra_events and broadcast are
+// zero for a plain "E #", so a Command written out as
+// { type, { args } } means the same as it always has. In the
+// same way a C* keeps its count in args[3], which is 0 for a
+// plain C.
+//
+// ============================================================
+struct Command
+{
+    CommandType type;
+    int args[COMMAND_EVENTS_MAX];
+    unsigned char extra_events;
+    bool broadcast;
+};
+
+//Enough room for the text of any Command: a name of at most
+//two characters, then one operand per field of args, each a
+//space and up to ten digits, and a NUL for callers that want
+//one. command.cpp checks this against the fields of Command.
+#define COMMAND_INT_DIGITS 10
+#define COMMAND_TEXT_MAX (2 + COMMAND_EVENTS_MAX * (1 + COMMAND_INT_DIGITS) + 1)
+
+// ============================================================
+//
+// One line of input as handed out by an InputReader. text is
+// the line exactly as it should be echoed. If decoded is set
+// the line came from a binary trace and command already holds
+// its meaning, otherwise text still has to be parsed.
+//
+// ============================================================
+struct InputLine
+{
+    const char * text;
+    size_t length;
+    bool decoded;
+    Command command;
+};
+
+// ============================================================
+//
+// Lines handed out one at a time by something other than an
+// InputReader or a CommandBuffer, such as a Pipeline's parser
+// stage or a daemon's producers. A line stays valid until the
+// next call to next().
+//
+// ============================================================
+class LineSource
+{
+public:
+    virtual bool next(InputLine&) = 0;
+protected:
+    ~LineSource() {}
+};
+
+bool parse_command(const char*, size_t, Command&);
+bool parse_int(const char*, const char*, int&);
+
+size_t format_command(const Command&, char*);
+
+#endif //COMMAND_H
@@ -0,0 +1,40 @@
+// File: command_buffer.cpp
+// --------------------------------------------------------
+// Class: CS 470                      Instructor: Dr. Hwang
+// Assignment: Process Scheduling     Date Assigned: 22 February 2016
+// Programmer: Evan Higgins           Date Completed: 18 March 2016
+
+#include "command_buffer.hpp"
+
+using namespace std;
+
+// ============================================================
+// Function: CommandBuffer(InputReader&)
+//
+// Reads input through its first X, or to the end if it has
+// none. Lines the scheduler would never reach after the X are
+// not kept.
+// ============================================================
+CommandBuffer::CommandBuffer(InputReader & input) {
+    //text may move while it grows, so lines only get their text
+    //pointers once everything is read.
+    vector<size_t> offsets;
+
+    InputLine line;
+    while(input.next(line)) {
+        offsets.push_back(text.size());
+        text.append(line.text, line.length);
+
+        //Invalid lines stay undecoded and are reported by the
+        //scheduler when it reaches them.
+        if(!line.decoded)
+            line.decoded = parse_command(line.text, line.length, line.command);
+        lines.push_back(line);
+
+        if(line.length == 1 && line.text[0] == 'X')
+            break;
+    }
+
+    for(size_t i = 0; i < lines.size(); ++i)
+        lines[i].text = text.data() + offsets[i];
+}
@@ -0,0 +1,61 @@
+// File: command_buffer.hpp
+// --------------------------------------------------------
+// Class: CS 470                      Instructor: Dr. Hwang
+// Assignment: Process Scheduling     Date Assigned: 22 February 2016
+// Programmer: Evan Higgins           Date Completed: 18 March 2016
+
+#ifndef COMMAND_BUFFER_H
+#define COMMAND_BUFFER_H
+
+#include <string>
+#include <vector>
+#include "command.hpp"
+#include "input_reader.hpp"
+
+// ============================================================
+//
+// An input read and parsed once, up to and including its
+// first X, and then never modified. Every valid line is stored
+// already decoded, so any number of schedulers can replay the
+// same buffer at the same time through their own Reader
+// without parsing it again.
+//
+// ============================================================
+class CommandBuffer
+{
+public:
+    CommandBuffer(InputReader&);
+
+    size_t size() const { return lines.size(); }
+
+    // ========================================================
+    //
+    // Hands out the lines of a CommandBuffer in order, the same
+    // way InputReader::next() does.
+    //
+    // ========================================================
+    class Reader
+    {
+    public:
+        Reader(const CommandBuffer & buffer) : buffer(buffer), position(0) {}
+
+        bool next(InputLine & line) {
+            if(position == buffer.lines.size())
+                return false;
+            line = buffer.lines[position++];
+            return true;
+        }
+    private:
+        const CommandBuffer & buffer;
+        size_t position;
+    };
+private:
+    //Holds the text of every line back to back.
+    std::string text;
+    std::vector<InputLine> lines;
+
+    CommandBuffer(const CommandBuffer&);
+    CommandBuffer& operator=(const CommandBuffer&);
+};
+
+#endif //COMMAND_BUFFER_H
@@ -0,0 +1,89 @@
+// File: cpu_list.cpp
+// --------------------------------------------------------
+// Class: CS 470                      Instructor: Dr. Hwang
+// Assignment: Process Scheduling     Date Assigned: 22 February 2016
+// Programmer: Evan Higgins           Date Completed: 18 March 2016
+
+#include "cpu_list.hpp"
+
+using namespace std;
+
+CpuList::CpuList(unsigned cpus) :
+    links(cpus, Links{ NO_CPU, NO_CPU, false }),
+    head(NO_CPU),
+    tail(NO_CPU)
+{
+}
+
+// ============================================================
+// Function: push_back(unsigned)
+//
+// Adds cpu at the back, unless it is already on the list.
+// ============================================================
+void CpuList::push_back(unsigned cpu) {
+    Links & link = links[cpu];
+    if(link.listed)
+        return;
+    link.listed = true;
+    link.prev = tail;
+    link.next = NO_CPU;
+    if(tail != NO_CPU)
+        links[tail].next = cpu;
+    else
+        head = cpu;
+    tail = cpu;
+}
+
+// ============================================================
+// Function: remove(unsigned)
+//
+// Takes cpu off the list, if it is on it.
+// ============================================================
+void CpuList::remove(unsigned cpu) {
+    Links & link = links[cpu];
+    if(!link.listed)
+        return;
+    if(link.prev != NO_CPU)
+        links[link.prev].next = link.next;
+    else
+        head = link.next;
+    if(link.next != NO_CPU)
+        links[link.next].prev = link.prev;
+    else
+        tail = link.prev;
+    link = Links{ NO_CPU, NO_CPU, false };
+}
+
+// ============================================================
+// Function: save(SnapshotWriter&)
+//
+// Writes the CPUs on the list from the front.
+// ============================================================
+void CpuList::save(SnapshotWriter & out) const {
+    size_t count = 0;
+    for(uint32_t cpu = head; cpu != NO_CPU; cpu = links[cpu].next)
+        ++count;
+    out.put(count);
+    for(uint32_t cpu = head; cpu != NO_CPU; cpu = links[cpu].next)
+        out.put(cpu);
+}
+
+// ============================================================
+// Function: restore(SnapshotReader&)
+// Returns:  bool
+//
+// Rebuilds the list from what save() wrote. Returns false if
+// a CPU is out of range or listed twice.
+// ============================================================
+bool CpuList::restore(SnapshotReader & in) {
+    while(!empty())
+        remove(front());
+    size_t count = in.get_count();
+    for(size_t i = 0; i < count && in.good(); ++i) {
+        uint64_t cpu = in.get();
+        if(cpu >= links.size() || links[cpu].listed)
+            return false;
+        push_back(static_cast<unsigned>(cpu));
+    }
+    return in.good();
+}
@@ -0,0 +1,53 @@
+// File: cpu_list.hpp
+// --------------------------------------------------------
+// Class: CS 470                      Instructor: Dr. Hwang
+// Assignment: Process Scheduling     Date Assigned: 22 February 2016
+// Programmer: Evan Higgins           Date Completed: 18 March 2016
+
+#ifndef CPU_LIST_H
+#define CPU_LIST_H
+
+#include <cstdint>
+#include <vector>
+#include "snapshot.hpp"
+
+//Ends a CpuList.
+const uint32_t NO_CPU = UINT32_MAX;
+
+// ============================================================
+//
+// A FIFO of CPU numbers, each on it at most once. The links
+// are indexed by CPU, so adding, removing and testing for any
+// CPU are all O(1) and nothing is allocated after
+// construction. The scheduler keeps its idle CPUs and the CPUs
+// with something queued on these.
+//
+// ============================================================
+class CpuList
+{
+public:
+    CpuList(unsigned);
+
+    bool empty() const { return head == NO_CPU; }
+    unsigned front() const { return head; }
+    bool contains(unsigned cpu) const { return links[cpu].listed; }
+
+    void push_back(unsigned);
+    void remove(unsigned);
+
+    void save(SnapshotWriter&) const;
+    bool restore(SnapshotReader&);
+private:
+    struct Links
+    {
+        uint32_t prev;
+        uint32_t next;
+        bool listed;
+    };
+
+    std::vector<Links> links;
+    uint32_t head;
+    uint32_t tail;
+};
+
+#endif //CPU_LIST_H
@@ -0,0 +1,430 @@
+// File: daemon.cpp
+// --------------------------------------------------------
+// Class: CS 470                      Instructor: Dr. Hwang
+// Assignment: Process Scheduling     Date Assigned: 22 February 2016
+// Programmer: Evan Higgins           Date Completed: 18 March 2016
+
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "daemon.hpp"
+#include "scheduler.hpp"
+
+using namespace std;
+
+//Times the simulation polls an empty queue before sleeping.
+#define DAEMON_SPINS 64
+
+LatencyHistogram::LatencyHistogram() :
+    buckets(LATENCY_SUB_BUCKETS + (64 - 4) * LATENCY_SUB_BUCKETS),
+    total(0) {}
+
+// ============================================================
+// Function: bucket_of(uint64_t)
+// Returns:  size_t
+//
+// Values below LATENCY_SUB_BUCKETS get a bucket each. Above
+// that, the bucket is picked by the most significant bit and
+// the four bits below it.
+// ============================================================
+size_t LatencyHistogram::bucket_of(uint64_t ns) {
+    if(ns < LATENCY_SUB_BUCKETS)
+        return ns;
+    int shift = 63 - __builtin_clzll(ns) - 4;
+    return LATENCY_SUB_BUCKETS + shift * LATENCY_SUB_BUCKETS +
+           ((ns >> shift) - LATENCY_SUB_BUCKETS);
+}
+
+// ============================================================
+// Function: bucket_top(size_t)
+// Returns:  uint64_t
+//
+// The largest value that falls in bucket. The top bucket wraps
+// around to the largest uint64_t.
+// ============================================================
+uint64_t LatencyHistogram::bucket_top(size_t bucket) {
+    if(bucket < LATENCY_SUB_BUCKETS)
+        return bucket;
+    size_t shift = (bucket - LATENCY_SUB_BUCKETS) / LATENCY_SUB_BUCKETS;
+    uint64_t sub = (bucket - LATENCY_SUB_BUCKETS) % LATENCY_SUB_BUCKETS;
+    return ((LATENCY_SUB_BUCKETS + sub + 1) << shift) - 1;
+}
+
+// ============================================================
+// Function: add(uint64_t, uint64_t)
+//
+// Records count commands that each took ns nanoseconds.
+// ============================================================
+void LatencyHistogram::add(uint64_t ns, uint64_t count) {
+    buckets[bucket_of(ns)] += count;
+    total += count;
+}
+
+// ============================================================
+// Function: percentile(double)
+// Returns:  uint64_t
+//
+// The latency in nanoseconds that percent of the commands came
+// in at or under, rounded up to the top of its bucket. Returns
+// 0 if nothing has been recorded.
+// ============================================================
+uint64_t LatencyHistogram::percentile(double percent) const {
+    if(total == 0)
+        return 0;
+    uint64_t rank = static_cast<uint64_t>(ceil(percent / 100 * total));
+    if(rank < 1)
+        rank = 1;
+
+    uint64_t seen = 0;
+    for(size_t i = 0; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if(seen >= rank)
+            return bucket_top(i);
+    }
+    return bucket_top(buckets.size() - 1);
+}
+
+// ============================================================
+// Function: summary()
+// Returns:  string
+//
+// The command count and the median and 99th percentile in
+// microseconds, on one line.
+// ============================================================
+string LatencyHistogram::summary() const {
+    ostringstream text;
+    text << fixed << setprecision(1) << total << " commands, p50 "
+         << percentile(50) / 1000.0 << " us, p99 "
+         << percentile(99) / 1000.0 << " us";
+    return text.str();
+}
+
+// ============================================================
+// Function: Daemon(const string&, OutputBuffer&)
+//
+// Opens source, as described in daemon.hpp, for a simulation
+// writing to out. A socket left behind at source by an earlier
+// daemon is replaced; any other file there is left alone and
+// the daemon isn't good().
+// ============================================================
+Daemon::Daemon(const string & source, OutputBuffer & out) :
+    out(out),
+    ready(false),
+    source_fd(-1),
+    listening(false),
+    input_ended(false),
+    asleep(false),
+    active_readers(0),
+    frame(nullptr),
+    position(0)
+{
+    stop_pipe[0] = stop_pipe[1] = -1;
+    if(pipe(stop_pipe) != 0) {
+        cerr << "[ERROR]: Could not serve " << source << "." << endl;
+        return;
+    }
+
+    struct stat info;
+    bool exists = stat(source.c_str(), &info) == 0;
+    if(source == "-") {
+        source_fd = dup(STDIN_FILENO);
+    } else if(exists && S_ISFIFO(info.st_mode)) {
+        //Held open for writing as well, so the FIFO doesn't read
+        //as ended whenever no writer has it open.
+        source_fd = open(source.c_str(), O_RDWR);
+    } else {
+        if(exists && S_ISSOCK(info.st_mode))
+            unlink(source.c_str());
+
+        struct sockaddr_un address;
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if(source.size() < sizeof(address.sun_path)) {
+            strcpy(address.sun_path, source.c_str());
+            source_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+            if(source_fd >= 0 &&
+                    (bind(source_fd, reinterpret_cast<struct sockaddr*>(&address),
+                          sizeof(address)) != 0 ||
+                     listen(source_fd, SOMAXCONN) != 0)) {
+                close(source_fd);
+                source_fd = -1;
+            } else if(source_fd >= 0) {
+                listening = true;
+                socket_path = source;
+            }
+        }
+    }
+
+    if(source_fd < 0) {
+        cerr << "[ERROR]: Could not serve " << source << "." << endl;
+        return;
+    }
+    ready = true;
+}
+
+Daemon::~Daemon() {
+    if(source_fd >= 0)
+        close(source_fd);
+    if(listening)
+        unlink(socket_path.c_str());
+    for(int fd : stop_pipe)
+        if(fd >= 0)
+            close(fd);
+}
+
+// ============================================================
+// Function: run(Scheduler&)
+//
+// Starts taking commands from the source and runs scheduler on
+// them until an X, or until stdin ends. Producers still sending
+// when the run ends are cut off and the rest of their commands
+// dropped.
+// ============================================================
+void Daemon::run(Scheduler & scheduler) {
+    if(listening)
+        acceptor = thread(&Daemon::accept_producers, this);
+    else
+        start_reader(source_fd, false);
+
+    scheduler.run(static_cast<LineSource&>(*this));
+
+    //The frame holding the X still has its output to flush.
+    if(frame)
+        finish_frame();
+
+    stop();
+    while(Frame * left = frames.pop())
+        delete left;
+}
+
+// ============================================================
+// Function: next(InputLine&)
+// Returns:  bool
+//
+// Hands the scheduler the next line, moving on to the next
+// frame once one runs out. Returns false once stdin has ended
+// and every frame has run.
+// ============================================================
+bool Daemon::next(InputLine & line) {
+    while(!frame || position == frame->block.lines.size()) {
+        if(frame)
+            finish_frame();
+        frame = next_frame();
+        position = 0;
+        if(!frame)
+            return false;
+    }
+    line = frame->block.lines[position++];
+    return true;
+}
+
+// ============================================================
+// Function: next_frame()
+// Returns:  Frame*
+//
+// Waits for the next frame, spinning briefly before sleeping.
+// Returns nullptr once stdin has ended and nothing is left.
+// ============================================================
+Frame * Daemon::next_frame() {
+    for(int spins = 0; ; ++spins) {
+        if(Frame * next = frames.pop())
+            return next;
+        //Set after stdin's last push, so one more pop sees it.
+        if(input_ended.load(memory_order_acquire))
+            return frames.pop();
+
+        if(spins < DAEMON_SPINS) {
+            this_thread::yield();
+            continue;
+        }
+
+        unique_lock<mutex> lock(wakeup_lock);
+        asleep.store(true);
+        if(Frame * next = frames.pop()) {
+            asleep.store(false);
+            return next;
+        }
+        wakeup.wait_for(lock, chrono::milliseconds(1));
+        asleep.store(false);
+    }
+}
+
+// ============================================================
+// Function: finish_frame()
+//
+// Flushes the output of the frame that just ran, records the
+// latency of its commands and frees it.
+// ============================================================
+void Daemon::finish_frame() {
+    out.flush();
+    auto waited = chrono::steady_clock::now() - frame->received;
+    latencies.add(chrono::duration_cast<chrono::nanoseconds>(waited).count(),
+                  position);
+    delete frame;
+    frame = nullptr;
+}
+
+// ============================================================
+// Function: accept_producers()
+//
+// The acceptor thread. Starts a reader for every producer that
+// connects to the socket until the run is over.
+// ============================================================
+void Daemon::accept_producers() {
+    while(true) {
+        struct pollfd polled[2] = { { source_fd, POLLIN, 0 },
+                                    { stop_pipe[0], POLLIN, 0 } };
+        if(poll(polled, 2, -1) < 0) {
+            if(errno == EINTR)
+                continue;
+            return;
+        }
+        if(polled[1].revents)
+            return;
+
+        if(polled[0].revents & POLLIN) {
+            int producer = accept(source_fd, nullptr, nullptr);
+            if(producer >= 0)
+                start_reader(producer, true);
+        }
+    }
+}
+
+// ============================================================
+// Function: start_reader(int, bool)
+//
+// Starts a detached reader thread on fd, which it closes when
+// done if owned is set.
+// ============================================================
+void Daemon::start_reader(int fd, bool owned) {
+    {
+        lock_guard<mutex> lock(readers_lock);
+        ++active_readers;
+    }
+    thread(&Daemon::read_producer, this, fd, owned).detach();
+}
+
+// ============================================================
+// Function: read_producer(int, bool)
+//
+// A reader thread. Reads whatever fd has, decodes every whole
+// line in it and pushes the lines as frames of at most
+// FRAME_LINES_MAX, until fd ends or the run is over. A last
+// line without a newline still counts once fd ends. If fd is
+// the FIFO or stdin rather than a producer's connection, its
+// end is the end of the input.
+// ============================================================
+void Daemon::read_producer(int fd, bool owned) {
+    string pending;
+    bool ended = false;
+    while(!ended) {
+        struct pollfd polled[2] = { { fd, POLLIN, 0 },
+                                    { stop_pipe[0], POLLIN, 0 } };
+        if(poll(polled, 2, -1) < 0) {
+            if(errno == EINTR)
+                continue;
+            break;
+        }
+        if(polled[1].revents)
+            break;
+
+        size_t kept = pending.size();
+        pending.resize(kept + FRAME_READ_SIZE);
+        ssize_t got = read(fd, &pending[kept], FRAME_READ_SIZE);
+        if(got < 0 && (errno == EINTR || errno == EAGAIN)) {
+            pending.resize(kept);
+            continue;
+        }
+        pending.resize(kept + (got > 0 ? got : 0));
+        ended = got <= 0;
+        auto received = chrono::steady_clock::now();
+
+        size_t start = 0;
+        while(start < pending.size()) {
+            Frame * next = new Frame;
+            next->received = received;
+            LineBlock & block = next->block;
+
+            //Reserved up front, so text never moves once lines
+            //point into it.
+            block.text.reserve(pending.size() - start);
+            while(block.lines.size() < FRAME_LINES_MAX && start < pending.size()) {
+                const char * newline = static_cast<const char*>(
+                        memchr(pending.data() + start, '\n', pending.size() - start));
+                if(!newline && !ended)
+                    break;
+                size_t end = newline ? newline - pending.data() : pending.size();
+
+                InputLine line;
+                size_t offset = block.text.size();
+                block.text.append(pending, start, end - start);
+                line.text = block.text.data() + offset;
+                line.length = end - start;
+                //Invalid lines stay undecoded and are reported by
+                //the scheduler when it reaches them.
+                line.decoded = parse_command(line.text, line.length, line.command);
+                block.lines.push_back(line);
+                start = newline ? end + 1 : end;
+            }
+
+            if(block.lines.empty()) {
+                delete next;
+                break;
+            }
+            push_frame(next);
+        }
+        pending.erase(0, start);
+    }
+
+    if(owned) {
+        close(fd);
+    } else if(ended) {
+        input_ended.store(true, memory_order_release);
+        lock_guard<mutex> lock(wakeup_lock);
+        wakeup.notify_one();
+    }
+
+    //The daemon may be gone as soon as stop() sees the count
+    //drop, so the lock is only let go as the thread exits.
+    unique_lock<mutex> lock(readers_lock);
+    --active_readers;
+    notify_all_at_thread_exit(readers_done, move(lock));
+}
+
+// ============================================================
+// Function: push_frame(Frame*)
+//
+// Queues next for the simulation, waking it if it's asleep.
+// ============================================================
+void Daemon::push_frame(Frame * next) {
+    frames.push(next);
+    if(asleep.load()) {
+        lock_guard<mutex> lock(wakeup_lock);
+        wakeup.notify_one();
+    }
+}
+
+// ============================================================
+// Function: stop()
+//
+// Tells every thread the run is over and waits for them all.
+// ============================================================
+void Daemon::stop() {
+    ssize_t written = write(stop_pipe[1], "", 1);
+    (void)written;
+
+    if(acceptor.joinable())
+        acceptor.join();
+
+    unique_lock<mutex> lock(readers_lock);
+    readers_done.wait(lock, [this]() { return active_readers == 0; });
+}
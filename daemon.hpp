@@ -0,0 +1,159 @@
+// File: daemon.hpp
+// --------------------------------------------------------
+// Class: CS 470                      Instructor: Dr. Hwang
+// Assignment: Process Scheduling     Date Assigned: 22 February 2016
+// Programmer: Evan Higgins           Date Completed: 18 March 2016
+
+#ifndef DAEMON_H
+#define DAEMON_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "command.hpp"
+#include "mpsc_queue.hpp"
+#include "output_buffer.hpp"
+#include "pipeline.hpp"
+
+class Scheduler;
+
+//Most lines a frame holds. A longer burst from one producer is
+//split, so output is flushed at least this often.
+#define FRAME_LINES_MAX 256
+
+//Bytes a producer's reader asks for at once.
+#define FRAME_READ_SIZE (1 << 16)
+
+// ============================================================
+//
+// Command latencies, from a frame arriving to the flush that
+// carried its last state out. Each power of two range of
+// nanoseconds is split into LATENCY_SUB_BUCKETS buckets, so a
+// percentile is read to within about 6% in constant memory
+// however long the daemon runs.
+//
+// ============================================================
+#define LATENCY_SUB_BUCKETS 16
+
+class LatencyHistogram
+{
+public:
+    LatencyHistogram();
+
+    void add(uint64_t, uint64_t);
+
+    uint64_t count() const { return total; }
+    uint64_t percentile(double) const;
+    std::string summary() const;
+private:
+    std::vector<uint64_t> buckets;
+    uint64_t total;
+
+    static size_t bucket_of(uint64_t);
+    static uint64_t bucket_top(size_t);
+};
+
+// ============================================================
+//
+// The lines one producer sent in one go, already decoded, and
+// when they arrived.
+//
+// ============================================================
+struct Frame
+{
+    LineBlock block;
+    std::chrono::steady_clock::time_point received;
+    std::atomic<Frame*> next;
+};
+
+// ============================================================
+//
+// Runs a simulation for as long as commands keep coming, from
+// one of:
+//  "-"          stdin, until it ends
+//  a FIFO       any number of writers, which should write whole
+//               lines of at most PIPE_BUF bytes at a time
+//  anything     a Unix domain socket created at that path, which
+//  else         any number of producers may connect to
+//
+// A FIFO or socket is served until a producer sends X. Each
+// producer has a reader thread that decodes whatever it sends
+// into frames and pushes them onto one MpscQueue, which the
+// simulation drains on the calling thread. Output is flushed
+// after every frame, so a command's state goes out as soon as
+// its frame has run, and the latency of every command is kept.
+//
+// ============================================================
+class Daemon : private LineSource
+{
+public:
+    Daemon(const std::string&, OutputBuffer&);
+    ~Daemon();
+
+    //False, after printing why, if the source couldn't be
+    //opened.
+    bool good() const { return ready; }
+
+    void run(Scheduler&);
+
+    const LatencyHistogram & latency() const { return latencies; }
+private:
+    OutputBuffer & out;
+    std::string socket_path;
+    bool ready;
+
+    //The FIFO or stdin, or the socket producers connect to.
+    int source_fd;
+    bool listening;
+
+    //Written to once the run is over. Every thread polls the
+    //read end alongside its own descriptor.
+    int stop_pipe[2];
+
+    MpscQueue<Frame> frames;
+
+    //Set once stdin has ended and its last frame is queued.
+    std::atomic<bool> input_ended;
+
+    //The simulation sleeps on wakeup when the queue stays empty,
+    //and producers only take the lock to wake it while asleep
+    //is set. The wait is also timed, so a wakeup lost between
+    //the two still only costs a millisecond.
+    std::mutex wakeup_lock;
+    std::condition_variable wakeup;
+    std::atomic<bool> asleep;
+
+    //Reader threads are detached, so a daemon that sees many
+    //producers come and go doesn't collect finished threads.
+    //stop() waits for active_readers to reach zero instead.
+    std::thread acceptor;
+    std::mutex readers_lock;
+    std::condition_variable readers_done;
+    size_t active_readers;
+
+    //The frame being run and the next line in it.
+    Frame * frame;
+    size_t position;
+
+    LatencyHistogram latencies;
+
+    bool next(InputLine&);
+    Frame * next_frame();
+    void finish_frame();
+
+    void accept_producers();
+    void start_reader(int, bool);
+    void read_producer(int, bool);
+    void push_frame(Frame*);
+    void stop();
+
+    Daemon(const Daemon&);
+    Daemon& operator=(const Daemon&);
+};
+
+#endif //DAEMON_H
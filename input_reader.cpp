@@ -0,0 +1,208 @@
+// File: input_reader.cpp
+// --------------------------------------------------------
+// Class: CS 470                      Instructor: Dr. Hwang
+// Assignment: Process Scheduling     Date Assigned: 22 February 2016
+// Programmer: Evan Higgins           Date Completed: 18 March 2016
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <iostream>
+#include <unistd.h>
+#include "binary_trace.hpp"
+#include "input_reader.hpp"
+
+#define READ_BLOCK_SIZE (1 << 20)
+
+using namespace std;
+
+// ============================================================
+// Function: InputReader(string)
+//
+// Opens file_name, or stdin if file_name is "-", and maps it
+// if it is a regular file. good() is false if the file could
+// not be opened.
+// ============================================================
+InputReader::InputReader(const string & file_name) :
+    fd(-1),
+    mapped(nullptr),
+    mapped_size(0),
+    mapped_offset(0),
+    binary(false),
+    buffer_begin(0),
+    buffer_end(0),
+    at_eof(false),
+    consumed(0)
+{
+    if(file_name == "-")
+        fd = dup(STDIN_FILENO);
+    else
+        fd = open(file_name.c_str(), O_RDONLY);
+
+    if(fd < 0)
+        return;
+
+    struct stat info;
+    if(fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        void * map = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(map != MAP_FAILED) {
+            madvise(map, info.st_size, MADV_SEQUENTIAL);
+            mapped = static_cast<const char*>(map);
+            mapped_size = info.st_size;
+            if(is_binary_trace(mapped, mapped_size)) {
+                binary = true;
+                mapped_offset = TRACE_HEADER_SIZE;
+            }
+            return;
+        }
+    }
+
+    buffer.resize(READ_BLOCK_SIZE);
+}
+
+InputReader::~InputReader() {
+    if(mapped)
+        munmap(const_cast<char*>(mapped), mapped_size);
+    if(fd >= 0)
+        close(fd);
+}
+
+// ============================================================
+// Function: next(InputLine&)
+// Returns:  bool
+//
+// Hands out the next line of input. Returns false once the
+// input is exhausted, or if a binary trace turns out to be
+// corrupt.
+// ============================================================
+bool InputReader::next(InputLine & line) {
+    if(!binary) {
+        line.decoded = false;
+        return next_line(line.text, line.length);
+    }
+
+    const char * cursor = mapped + mapped_offset;
+    TraceStatus status =
+        read_trace_record(cursor, mapped + mapped_size, line, command_text);
+    if(status == TraceStatus::Corrupt)
+        cerr << "[ERROR]: Corrupt binary trace at offset " << mapped_offset << endl;
+    mapped_offset = cursor - mapped;
+    return status == TraceStatus::Record;
+}
+
+// ============================================================
+// Function: next_line(const char*&, size_t&)
+// Returns:  bool
+//
+// Points line at the next line of input and sets length to
+// its length, not counting the newline. Returns false once the
+// input is exhausted. A final line without a trailing newline
+// is still returned.
+// ============================================================
+bool InputReader::next_line(const char *& line, size_t & length) {
+    if(mapped) {
+        if(mapped_offset >= mapped_size)
+            return false;
+
+        line = mapped + mapped_offset;
+        size_t remaining = mapped_size - mapped_offset;
+        const char * newline =
+            static_cast<const char*>(memchr(line, '\n', remaining));
+        length = newline ? newline - line : remaining;
+        mapped_offset += length + 1;
+        return true;
+    }
+
+    if(fd < 0)
+        return false;
+
+    size_t searched = 0;
+    while(true) {
+        char * begin = buffer.data() + buffer_begin;
+        size_t available = buffer_end - buffer_begin;
+        char * newline = static_cast<char*>(
+                memchr(begin + searched, '\n', available - searched));
+        if(newline) {
+            line = begin;
+            length = newline - begin;
+            buffer_begin += length + 1;
+            consumed += length + 1;
+            return true;
+        }
+        searched = available;
+
+        if(!fill_buffer()) {
+            if(available == 0)
+                return false;
+            line = begin;
+            length = available;
+            buffer_begin = buffer_end;
+            consumed += length;
+            return true;
+        }
+    }
+}
+
+// ============================================================
+// Function: seek(size_t)
+// Returns:  bool
+//
+// Moves to offset, which must be the offset() of an earlier
+// reader of the same input. Mapped input jumps straight there.
+// Anything else can only be read forward, so the lines before
+// offset are read and dropped. Returns false if offset can't
+// be the start of a line or record of this input.
+// ============================================================
+bool InputReader::seek(size_t target) {
+    if(mapped) {
+        if(binary ? target < TRACE_HEADER_SIZE || target > mapped_size
+                  : target > mapped_size + 1 ||
+                    (target > 0 && target <= mapped_size &&
+                     mapped[target - 1] != '\n'))
+            return false;
+        mapped_offset = target;
+        return true;
+    }
+
+    const char * line;
+    size_t length;
+    while(consumed < target && next_line(line, length));
+    return consumed == target;
+}
+
+// ============================================================
+// Function: fill_buffer()
+// Returns:  bool
+//
+// Moves the unread bytes to the front of the buffer, growing
+// it if a single line fills it, and reads another block.
+// Returns false once nothing more can be read.
+// ============================================================
+bool InputReader::fill_buffer() {
+    if(at_eof)
+        return false;
+
+    size_t available = buffer_end - buffer_begin;
+    if(buffer_begin > 0) {
+        memmove(buffer.data(), buffer.data() + buffer_begin, available);
+        buffer_begin = 0;
+        buffer_end = available;
+    }
+    if(buffer_end == buffer.size())
+        buffer.resize(buffer.size() * 2);
+
+    while(true) {
+        ssize_t count = read(fd, buffer.data() + buffer_end,
+                             buffer.size() - buffer_end);
+        if(count > 0) {
+            buffer_end += count;
+            return true;
+        }
+        if(count < 0 && errno == EINTR)
+            continue;
+        at_eof = true;
+        return false;
+    }
+}
@@ -0,0 +1,71 @@
+// File: input_reader.hpp
+// --------------------------------------------------------
+// Class: CS 470                      Instructor: Dr. Hwang
+// Assignment: Process Scheduling     Date Assigned: 22 February 2016
+// Programmer: Evan Higgins           Date Completed: 18 March 2016
+
+#ifndef INPUT_READER_H
+#define INPUT_READER_H
+
+#include <string>
+#include <vector>
+#include "command.hpp"
+
+// ============================================================
+//
+// Hands out the input one line at a time without copying it.
+// Regular files are memory mapped and lines point straight
+// into the mapping. Anything else (stdin when the file name is
+// "-", pipes, FIFOs) is read in large blocks into a buffer
+// that lines point into instead. Lines stay valid until the
+// next call to next_line().
+//
+// next() also understands binary traces (see binary_trace.hpp)
+// and hands out their records already decoded. Binary traces
+// have to be mapped, so they can't be read from a pipe.
+//
+// ============================================================
+class InputReader
+{
+public:
+    InputReader(const std::string&);
+    ~InputReader();
+
+    bool good() const { return fd >= 0; }
+    bool is_binary() const { return binary; }
+
+    bool next(InputLine&);
+    bool next_line(const char*&, size_t&);
+
+    //Bytes of input handed out so far, binary trace header
+    //included.
+    size_t offset() const { return mapped ? mapped_offset : consumed; }
+    bool seek(size_t);
+private:
+    int fd;
+
+    //Set when the whole input is mapped.
+    const char * mapped;
+    size_t mapped_size;
+    size_t mapped_offset;
+
+    //Set when the mapped input is a binary trace. Decoded
+    //commands have their text written to command_text.
+    bool binary;
+    char command_text[COMMAND_TEXT_MAX];
+
+    //Used when the input can't be mapped. Holds the bytes in
+    //[buffer_begin, buffer_end) which haven't been handed out.
+    std::vector<char> buffer;
+    size_t buffer_begin;
+    size_t buffer_end;
+    bool at_eof;
+    size_t consumed;
+
+    bool fill_buffer();
+
+    InputReader(const InputReader&);
+    InputReader& operator=(const InputReader&);
+};
+
+#endif //INPUT_READER_H
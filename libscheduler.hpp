@@ -0,0 +1,43 @@
+// File: libscheduler.hpp
+// --------------------------------------------------------
+// Class: CS 470                      Instructor: Dr. Hwang
+// Assignment: Process Scheduling     Date Assigned: 22 February 2016
+// Programmer: Evan Higgins           Date Completed: 18 March 2016
+
+#ifndef LIBSCHEDULER_H
+#define LIBSCHEDULER_H
+
+// ============================================================
+//
+// Everything a program linking libscheduler.a (make lib) needs
+// to run simulations in memory, without input or output files:
+//
+//     class Counter : public StateSink { ... };
+//
+//     Counter sink;
+//     std::unique_ptr<Scheduler> scheduler =
+//             make_scheduler(SchedulingPolicy::RoundRobin, 5, 1, sink);
+//     Command create = { CommandType::Create, { 1, 20, 0 } };
+//     if(scheduler->submit(create) != SubmitStatus::Ok)
+//         ...
+//
+// The sink is the caller's own StateSink and gets every
+// transition as it happens, with the processes involved. A
+// sink that overrides submitted() never sees the commands as
+// text, and nothing else is formatted unless the sink asks for
+// it. Failures come back as SubmitStatus values and bool
+// results; the library never exits, and only writes to stderr
+// from the file based entry points (run() on an input, the
+// snapshot files) that an embedding program need not use.
+// Link with -lz -pthread.
+//
+// ============================================================
+
+#include "command.hpp"
+#include "process.hpp"
+#include "scheduler.hpp"
+#include "scheduling_policy.hpp"
+#include "snapshot.hpp"
+#include "state_sink.hpp"
+
+#endif //LIBSCHEDULER_H
@@ -1,20 +1,464 @@
+#include <cerrno>
+#include <cstdlib>
 #include <iostream>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include "batch.hpp"
+#include "command_buffer.hpp"
+#include "daemon.hpp"
+#include "parallel.hpp"
+#include "pipeline.hpp"
 #include "scheduler.hpp"
 #include "process.hpp"
+#include "simulation.hpp"
 
 using namespace std;
 
+void print_usage() {
+    cout << "Execute with: \"./out [options] time_quantum input_file output_file\"" << endl;
+    cout << "          or: \"./out [options] --sweep QUANTA input_file output_pattern\"" << endl;
+    cout << "          or: \"./out [options] --batch manifest_or_directory output_dir\"" << endl;
+    cout << "input_file may be - to read commands from stdin." << endl;
+    cout << "output_file may be - to write to stdout." << endl;
+    cout << "Options:" << endl;
+    cout << "  --reclaim-budget N   Release at most N terminated processes per tick" << endl;
+    cout << "  --output MODE        full (default), delta, sampled, summary or binary" << endl;
+    cout << "  --sample-every N     Ticks between states in sampled mode (default 100)" << endl;
+    cout << "  --compress           Compress the binary state log" << endl;
+    cout << "  --policy POLICY      rr (default), mlfq, priority, srb or cfs" << endl;
+    cout << "  --cpus N             Simulate N CPUs, each with its own ready queue" << endl;
+    cout << "  --affinity MODE      local (default) queues new processes on their" << endl;
+    cout << "                       parent's CPU, spread on each CPU in turn" << endl;
+    cout << "  --metrics FILE       Write scheduler metrics to FILE as JSON" << endl;
+    cout << "                       (builds made with make metrics only)" << endl;
+    cout << "  --sweep QUANTA       Run every quantum in a list such as 1,5,10 or 1-10," << endl;
+    cout << "                       at most " << SWEEP_QUANTA_MAX << " in all, writing output_pattern" << endl;
+    cout << "                       with %q replaced by the quantum" << endl;
+    cout << "  --pipeline           Parse, simulate and format on separate threads" << endl;
+    cout << "  --serve              Run as a daemon on input_file: - for stdin, a FIFO," << endl;
+    cout << "                       or a Unix socket to create there, flushing output" << endl;
+    cout << "                       as each producer's commands run" << endl;
+    cout << "  --jobs N             Simulations to run at once in a sweep or batch" << endl;
+    cout << "                       (default: all cores)" << endl;
+    cout << "  --batch              Run every job in a manifest of" << endl;
+    cout << "                       \"input_file quantum [output_file]\" lines, or every" << endl;
+    cout << "                       file in a directory with each quantum from --sweep" << endl;
+    cout << "  --checkpoint N FILE  Write a snapshot to FILE once N commands have run" << endl;
+    cout << "  --restore FILE       Resume from a snapshot, writing only what follows it" << endl;
+    cout << "                       (full and delta output only)" << endl;
+    cout << "  --snapshot-every N   Write a snapshot every N ticks to output_file.idx" << endl;
+    cout << "  --from-tick T INDEX  Start from tick T using the snapshots in INDEX," << endl;
+    cout << "                       writing the state there and what follows it" << endl;
+    cout << "                       (full and delta output only)" << endl;
+}
+
+// ============================================================
+// Function: parse_number(const char*, long&)
+// Returns:  bool
+//
+// Reads a whole option value as a number. Returns false if
+// any of it isn't, so "abc" can't pass for 0.
+// ============================================================
+bool parse_number(const char * text, long & value) {
+    char * end;
+    errno = 0;
+    value = strtol(text, &end, 10);
+    return end != text && *end == '\0' && errno == 0;
+}
+
+// ============================================================
+// Function: run_sweep(InputReader&, const vector<int>&,
+//                     const string&, const RunOptions&, unsigned)
+// Returns:  int
+//
+// Parses input once and runs it with every quantum in quanta,
+// several at a time. Returns the exit status.
+// ============================================================
+int run_sweep(InputReader & input,
+              const vector<int> & quanta,
+              const string & pattern,
+              const RunOptions & options,
+              unsigned jobs) {
+    if(pattern.find("%q") == string::npos && quanta.size() > 1) {
+        cerr << "[ERROR]: Sweep output pattern must contain %q." << endl;
+        return 1;
+    }
+
+    const CommandBuffer commands(input);
+
+    vector<char> succeeded(quanta.size());
+    parallel_for(quanta.size(), jobs, [&](size_t i) {
+                succeeded[i] = simulate(quanta[i], commands,
+                                        sweep_output_name(pattern, quanta[i]),
+                                        options);
+            });
+
+    for(char ok : succeeded)
+        if(!ok)
+            return 1;
+    return 0;
+}
+
+// ============================================================
+// Function: run_batch_source(const string&, const string&,
+//                            const vector<int>&,
+//                            const RunOptions&, unsigned)
+// Returns:  int
+//
+// Runs the batch described by source, a manifest or a
+// directory of traces. Returns the exit status.
+// ============================================================
+int run_batch_source(const string & source,
+                     const string & output_dir,
+                     const vector<int> & quanta,
+                     const RunOptions & options,
+                     unsigned jobs) {
+    struct stat info;
+    bool is_directory = stat(source.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+    if(is_directory && quanta.empty()) {
+        cerr << "[ERROR]: A batch directory needs its quanta from --sweep." << endl;
+        return 1;
+    }
+
+    vector<BatchJob> batch;
+    if(is_directory ? !read_batch_directory(source, quanta, output_dir, batch)
+                    : !read_batch_manifest(source, output_dir, batch))
+        return 1;
+
+    mkdir(output_dir.c_str(), 0777);
+    return run_batch(batch, options, jobs) ? 0 : 1;
+}
+
+// ============================================================
+// Function: write_metrics(const string&, const Scheduler&)
+// Returns:  bool
+//
+// Writes the metrics of scheduler to the file name as JSON.
+// Returns false if it can't be opened.
+// ============================================================
+bool write_metrics(const string & name, const Scheduler & scheduler) {
+    OutputBuffer metrics_output(name);
+    if(!metrics_output.good()) {
+        cerr << "[ERROR]: Metrics file did not open correctly." << endl;
+        return false;
+    }
+    scheduler.get_metrics().write_json(metrics_output);
+    return true;
+}
+
+// ============================================================
+// Function: run_pipelined(InputReader&, OutputBuffer&, int,
+//                         const RunOptions&, const string&)
+// Returns:  int
+//
+// Runs input through a Pipeline, writing to output and then
+// to metrics_file if it isn't empty. Returns the exit status.
+// ============================================================
+int run_pipelined(InputReader & input,
+                  OutputBuffer & output,
+                  int quantum,
+                  const RunOptions & options,
+                  const string & metrics_file) {
+    Pipeline pipeline(input, output, options);
+    unique_ptr<Scheduler> scheduler = make_scheduler(options.policy, quantum,
+                                                     options.cpus, pipeline.sink());
+    scheduler->set_reclaim_budget(options.reclaim_budget);
+    scheduler->set_affinity(options.affinity);
+    if(!pipeline.run(*scheduler))
+        return 1;
+    output.close();
+
+    if(!metrics_file.empty() && !write_metrics(metrics_file, *scheduler))
+        return 1;
+    return 0;
+}
+
+// ============================================================
+// Function: run_daemon(const string&, const string&, int,
+//                      const RunOptions&, const string&)
+// Returns:  int
+//
+// Serves commands from source through a Daemon, writing to the
+// file output_name and then to metrics_file if it isn't empty,
+// and reports the latency of the commands on stderr. Returns
+// the exit status.
+// ============================================================
+int run_daemon(const string & source,
+               const string & output_name,
+               int quantum,
+               const RunOptions & options,
+               const string & metrics_file) {
+    OutputBuffer output(output_name);
+    if(!output.good()) {
+        cerr << "[ERROR]: Output file did not open correctly." << endl;
+        return 1;
+    }
+
+    Daemon daemon(source, output);
+    if(!daemon.good())
+        return 1;
+
+    unique_ptr<StateSink> sink = make_sink(options, output);
+    unique_ptr<Scheduler> scheduler = make_scheduler(options.policy, quantum,
+                                                     options.cpus, *sink);
+    scheduler->set_reclaim_budget(options.reclaim_budget);
+    scheduler->set_affinity(options.affinity);
+    daemon.run(*scheduler);
+
+    sink.reset();
+    output.close();
+    cerr << "Latency: " << daemon.latency().summary() << endl;
+
+    if(!metrics_file.empty() && !write_metrics(metrics_file, *scheduler))
+        return 1;
+    return 0;
+}
+
+// ============================================================
+// Function: resume_input(const SnapshotInfo&,
+//                        const SnapshotInfo&, InputReader&)
+// Returns:  bool
+//
+// Checks that a snapshot, taken as restored describes, can
+// resume the run info describes, and seeks input to where it
+// was taken. Returns false, after printing why, if not.
+// ============================================================
+bool resume_input(const SnapshotInfo & restored,
+                  const SnapshotInfo & info,
+                  InputReader & input) {
+    if(restored.quantum != info.quantum || restored.policy != info.policy ||
+            restored.reclaim_budget != info.reclaim_budget ||
+            restored.cpus != info.cpus || restored.affinity != info.affinity) {
+        cerr << "[ERROR]: Snapshot was taken with different scheduling options." << endl;
+        return false;
+    }
+    if(!input.seek(restored.input_offset)) {
+        cerr << "[ERROR]: Snapshot does not match the input file." << endl;
+        return false;
+    }
+    return true;
+}
+
 int main(int argc, char** argv) {
-    if(argc != 4) {
+    RunOptions options;
+    vector<int> sweep_quanta;
+    unsigned jobs = default_thread_count();
+    bool batch = false;
+    bool pipelined = false;
+    bool served = false;
+    string metrics_file;
+    size_t checkpoint_at = 0;
+    string checkpoint_file;
+    string restore_file;
+    uint64_t snapshot_interval = 0;
+    uint64_t from_tick = 0;
+    string index_file;
+
+    int arg = 1;
+    for(; arg < argc && string(argv[arg]).compare(0, 2, "--") == 0; ++arg) {
+        string option = argv[arg];
+        long number;
+        if(option == "--reclaim-budget" && arg + 1 < argc &&
+                parse_number(argv[arg + 1], number) && number >= 0) {
+            options.reclaim_budget = number;
+            ++arg;
+        } else if(option == "--output" && arg + 1 < argc &&
+                  parse_output_mode(argv[arg + 1], options.output_mode)) {
+            ++arg;
+        } else if(option == "--sample-every" && arg + 1 < argc &&
+                  parse_number(argv[arg + 1], number) && number > 0) {
+            options.sample_interval = number;
+            ++arg;
+        } else if(option == "--compress") {
+            options.compress = true;
+        } else if(option == "--policy" && arg + 1 < argc &&
+                  parse_scheduling_policy(argv[arg + 1], options.policy)) {
+            ++arg;
+        } else if(option == "--cpus" && arg + 1 < argc &&
+                  atol(argv[arg + 1]) > 0 && atol(argv[arg + 1]) <= MAX_CPUS) {
+            options.cpus = atol(argv[++arg]);
+        } else if(option == "--affinity" && arg + 1 < argc &&
+                  parse_affinity(argv[arg + 1], options.affinity)) {
+            ++arg;
+        } else if(option == "--sweep" && arg + 1 < argc &&
+                  parse_quantum_list(argv[arg + 1], sweep_quanta)) {
+            ++arg;
+        } else if(option == "--metrics" && arg + 1 < argc) {
+            if(!Metrics::enabled) {
+                cout << "[ERROR]: --metrics needs a build made with make metrics." << endl;
+                exit(1);
+            }
+            metrics_file = argv[++arg];
+        } else if(option == "--checkpoint" && arg + 2 < argc && atol(argv[arg + 1]) > 0) {
+            checkpoint_at = atol(argv[++arg]);
+            checkpoint_file = argv[++arg];
+        } else if(option == "--restore" && arg + 1 < argc) {
+            restore_file = argv[++arg];
+        } else if(option == "--snapshot-every" && arg + 1 < argc && atol(argv[arg + 1]) > 0) {
+            snapshot_interval = atol(argv[++arg]);
+        } else if(option == "--from-tick" && arg + 2 < argc && atol(argv[arg + 1]) >= 0) {
+            from_tick = atol(argv[++arg]);
+            index_file = argv[++arg];
+        } else if(option == "--pipeline") {
+            pipelined = true;
+        } else if(option == "--serve") {
+            served = true;
+        } else if(option == "--batch") {
+            batch = true;
+        } else if(option == "--jobs" && arg + 1 < argc && atoi(argv[arg + 1]) > 0) {
+            jobs = atoi(argv[++arg]);
+        } else {
+            cout << "[ERROR]: Unrecognized option: " << option << endl;
+            print_usage();
+            exit(1);
+        }
+    }
+
+    //The state log records dispatches as taken from the front
+    //of the one ready queue, which only holds for round robin on
+    //a single CPU.
+    if(options.output_mode == OutputMode::Binary &&
+            (options.policy != SchedulingPolicy::RoundRobin || options.cpus != 1)) {
+        cout << "[ERROR]: --output binary needs the rr policy and a single CPU." << endl;
+        exit(1);
+    }
+
+    bool snapshots = checkpoint_at > 0 || !restore_file.empty() ||
+                     snapshot_interval > 0 || !index_file.empty();
+    if(snapshots && (batch || !sweep_quanta.empty())) {
+        cout << "[ERROR]: Snapshot options only apply to a single run." << endl;
+        exit(1);
+    }
+
+    if(pipelined && (snapshots || batch || !sweep_quanta.empty())) {
+        cout << "[ERROR]: --pipeline only applies to a single run without snapshots." << endl;
+        exit(1);
+    }
+
+    if(served && (snapshots || pipelined || batch || !sweep_quanta.empty())) {
+        cout << "[ERROR]: --serve only applies to a single run without snapshots or --pipeline." << endl;
+        exit(1);
+    }
+
+    if((snapshot_interval > 0 || !index_file.empty()) &&
+            (checkpoint_at > 0 || !restore_file.empty() ||
+             (snapshot_interval > 0 && !index_file.empty()))) {
+        cout << "[ERROR]: --snapshot-every and --from-tick don't combine with other snapshot options." << endl;
+        exit(1);
+    }
+
+    //A resumed run can't reproduce what the counting sinks or the
+    //state log had accumulated before the snapshot.
+    if((!restore_file.empty() || !index_file.empty()) &&
+            options.output_mode != OutputMode::Full &&
+            options.output_mode != OutputMode::Delta) {
+        cout << "[ERROR]: --restore and --from-tick need --output full or delta." << endl;
+        exit(1);
+    }
+
+    //Sweeps and batches take their quanta from --sweep or the
+    //manifest instead of an argument.
+    int expected = sweep_quanta.empty() && !batch ? 3 : 2;
+    if(argc - arg != expected) {
         cout << "[ERROR]: Invalid number of arguments." << endl;
-        cout << "[ERROR]: Expected: 4" << endl;
-        cout << "[ERROR]: Found: " << argc << endl;
-        cout << "Execute with: \"./out time_quantum input_file output_file\"" << endl;
+        cout << "[ERROR]: Expected: " << expected << endl;
+        cout << "[ERROR]: Found: " << argc - arg << endl;
+        print_usage();
+        exit(1);
+    }
+
+    if(batch)
+        return run_batch_source(argv[arg], argv[arg + 1], sweep_quanta, options, jobs);
+
+    int input_arg = sweep_quanta.empty() ? arg + 1 : arg;
+
+    //The daemon reads its source itself.
+    if(served)
+        return run_daemon(argv[input_arg], argv[input_arg + 1], atoi(argv[arg]),
+                          options, metrics_file);
+
+    //Incorrectly opened files are an unrecoverable error.
+    InputReader input(argv[input_arg]);
+    if(!input.good()) {
+        cerr << "[ERROR]: Input file did not open correctly." << endl;
         exit(1);
     }
 
-    Scheduler foo(atoi(argv[1]), argv[2], argv[3]);
-    foo.run();
+    if(!sweep_quanta.empty())
+        return run_sweep(input, sweep_quanta, argv[input_arg + 1], options, jobs);
+
+    //The index goes next to the output file.
+    if(snapshot_interval > 0 && string(argv[input_arg + 1]) == "-") {
+        cerr << "[ERROR]: --snapshot-every needs an output file." << endl;
+        exit(1);
+    }
+
+    OutputBuffer output(argv[input_arg + 1]);
+    if(!output.good()) {
+        cerr << "[ERROR]: Output file did not open correctly." << endl;
+        exit(1);
+    }
+
+    if(pipelined)
+        return run_pipelined(input, output, atoi(argv[arg]), options, metrics_file);
+
+    unique_ptr<StateSink> sink = make_sink(options, output);
+    MutedSink muted(*sink);
+
+    SnapshotInfo info = { atoi(argv[arg]), options.policy, options.reclaim_budget,
+                          options.cpus, options.affinity, 0 };
+    unique_ptr<Scheduler> foo;
+    if(!restore_file.empty() || !index_file.empty()) {
+        SnapshotInfo restored;
+        if(!restore_file.empty())
+            foo = read_snapshot(restore_file, restored, *sink);
+        else
+            foo = read_snapshot_at(index_file, from_tick, restored, muted);
+        if(!foo || !resume_input(restored, info, input))
+            exit(1);
+    } else {
+        foo = make_scheduler(options.policy, info.quantum, options.cpus, *sink);
+        foo->set_reclaim_budget(options.reclaim_budget);
+        foo->set_affinity(options.affinity);
+    }
+
+    if(!index_file.empty()) {
+        //Lines aren't split, so an "I n" line can carry the
+        //replay a little past from_tick.
+        foo->run_until(input, from_tick);
+        if(foo->finished()) {
+            cerr << "[ERROR]: The run ends before tick " << from_tick << "." << endl;
+            exit(1);
+        }
+        muted.set_muted(false);
+        muted.state(*foo);
+    }
+
+    if(checkpoint_at > 0) {
+        if(checkpoint_at < foo->commands_run()) {
+            cerr << "[ERROR]: Checkpoint comes before the restored snapshot." << endl;
+            exit(1);
+        }
+        foo->run(input, checkpoint_at - foo->commands_run());
+        info.input_offset = input.offset();
+        if(!write_snapshot(checkpoint_file, info, *foo))
+            exit(1);
+    }
+
+    if(snapshot_interval > 0) {
+        if(!run_indexed(*foo, input, info, snapshot_interval,
+                        string(argv[input_arg + 1]) + ".idx"))
+            exit(1);
+    } else {
+        foo->run(input);
+    }
+
+    //The sink may still hold output, so it goes before the file.
+    sink.reset();
+    output.close();
+
+    if(!metrics_file.empty() && !write_metrics(metrics_file, *foo))
+        exit(1);
     return 0;
 }
-
@@ -0,0 +1,138 @@
+// File: metrics.cpp
+// --------------------------------------------------------
+// Class: CS 470                      Instructor: Dr. Hwang
+// Assignment: Process Scheduling     Date Assigned: 22 February 2016
+// Programmer: Evan Higgins           Date Completed: 18 March 2016
+
+#include "metrics.hpp"
+
+#ifdef SCHEDULER_METRICS
+
+#include <cstring>
+
+using namespace std;
+
+namespace {
+
+//Indexed like CommandType, then unparsable lines.
+const char * const KIND_NAMES[METRICS_COMMAND_KINDS] = {
+    "create", "destroy", "idle", "wait", "event", "exit", "invalid"
+};
+
+void write_field(OutputBuffer & out, const char * name, long long value, bool last = false) {
+    out.put('"');
+    out.write(name);
+    out.write("\": ");
+    out.put_int(value);
+    out.write(last ? "\n" : ",\n");
+}
+
+}
+
+Metrics::Metrics() :
+    dispatches(0),
+    quantum_expirations(0),
+    ready_enqueues(0),
+    wait_enqueues(0),
+    stale_entries(0),
+    steals(0),
+    timeouts(0),
+    samples(0),
+    ready_length_total(0),
+    wait_length_total(0),
+    ready_length_max(0),
+    wait_length_max(0)
+{
+    memset(commands, 0, sizeof(commands));
+    memset(latency_ns, 0, sizeof(latency_ns));
+    memset(histogram, 0, sizeof(histogram));
+}
+
+// ============================================================
+// Function: command(bool, CommandType, Time)
+//
+// Counts a finished input line and adds the time since started
+// to the histogram for its command type, or for invalid lines
+// if valid is false.
+// ============================================================
+void Metrics::command(bool valid, CommandType type, Time started) {
+    int kind = valid ? static_cast<int>(type) : METRICS_COMMAND_KINDS - 1;
+    uint64_t ns = chrono::duration_cast<chrono::nanoseconds>(
+            chrono::steady_clock::now() - started).count();
+
+    int bucket = 0;
+    while(bucket < METRICS_BUCKETS - 1 && ns >= (1ull << bucket))
+        ++bucket;
+
+    ++commands[kind];
+    latency_ns[kind] += ns;
+    ++histogram[kind][bucket];
+}
+
+// ============================================================
+// Function: queue_lengths(size_t, size_t)
+//
+// Records the ready and wait queue lengths at the end of a
+// tick. Lengths include entries gone stale that haven't been
+// skipped yet, since that is what the queues really hold.
+// ============================================================
+void Metrics::queue_lengths(size_t ready, size_t wait) {
+    ++samples;
+    ready_length_total += ready;
+    wait_length_total += wait;
+    if(ready > ready_length_max)
+        ready_length_max = ready;
+    if(wait > wait_length_max)
+        wait_length_max = wait;
+}
+
+// ============================================================
+// Function: write_json(OutputBuffer&)
+//
+// Writes every counter as one JSON object. Averages are given
+// in thousandths to stay in integers. Histograms only list
+// their nonempty buckets, as [upper bound in ns, count] pairs.
+// ============================================================
+void Metrics::write_json(OutputBuffer & out) const {
+    out.write("{\n");
+    write_field(out, "dispatches", dispatches);
+    write_field(out, "quantum_expirations", quantum_expirations);
+    write_field(out, "ready_enqueues", ready_enqueues);
+    write_field(out, "wait_enqueues", wait_enqueues);
+    write_field(out, "stale_entries_skipped", stale_entries);
+    write_field(out, "steals", steals);
+    write_field(out, "timeouts", timeouts);
+    write_field(out, "ready_queue_max", ready_length_max);
+    write_field(out, "ready_queue_avg_milli",
+                samples ? ready_length_total * 1000 / samples : 0);
+    write_field(out, "wait_queue_max", wait_length_max);
+    write_field(out, "wait_queue_avg_milli",
+                samples ? wait_length_total * 1000 / samples : 0);
+
+    out.write("\"commands\": {\n");
+    for(int kind = 0; kind < METRICS_COMMAND_KINDS; ++kind) {
+        out.put('"');
+        out.write(KIND_NAMES[kind]);
+        out.write("\": {\"count\": ");
+        out.put_int(commands[kind]);
+        out.write(", \"total_ns\": ");
+        out.put_int(latency_ns[kind]);
+        out.write(", \"histogram\": [");
+
+        bool first = true;
+        for(int bucket = 0; bucket < METRICS_BUCKETS; ++bucket) {
+            if(histogram[kind][bucket] == 0)
+                continue;
+            out.write(first ? "[" : ", [");
+            out.put_int(1ll << bucket);
+            out.write(", ");
+            out.put_int(histogram[kind][bucket]);
+            out.put(']');
+            first = false;
+        }
+        out.write(kind + 1 < METRICS_COMMAND_KINDS ? "]},\n" : "]}\n");
+    }
+    out.write("}\n}\n");
+}
+
+#endif //SCHEDULER_METRICS
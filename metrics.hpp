@@ -0,0 +1,105 @@
+// File: metrics.hpp
+// --------------------------------------------------------
+// Class: CS 470                      Instructor: Dr. Hwang
+// Assignment: Process Scheduling     Date Assigned: 22 February 2016
+// Programmer: Evan Higgins           Date Completed: 18 March 2016
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include "command.hpp"
+#include "output_buffer.hpp"
+
+//One latency histogram per command type, plus one for lines
+//that failed to parse.
+#define METRICS_COMMAND_KINDS 7
+
+//Histogram bucket i counts ticks that took under 2^i ns. The
+//last bucket also takes anything slower.
+#define METRICS_BUCKETS 40
+
+// ============================================================
+//
+// Counters and latency histograms collected by a Scheduler and
+// written out as JSON once the run is over.
+//
+// Metrics are only collected in builds with SCHEDULER_METRICS
+// defined (make metrics). Otherwise every method is an empty
+// inline function and Time an empty struct, so the calls in
+// the scheduler compile to nothing, clock reads included.
+//
+// ============================================================
+#ifdef SCHEDULER_METRICS
+
+class Metrics
+{
+public:
+    typedef std::chrono::steady_clock::time_point Time;
+
+    static const bool enabled = true;
+
+    Metrics();
+
+    Time start() const { return std::chrono::steady_clock::now(); }
+    void command(bool, CommandType, Time);
+
+    void dispatched() { ++dispatches; }
+    void quantum_expired() { ++quantum_expirations; }
+    void ready_enqueued() { ++ready_enqueues; }
+    void wait_enqueued() { ++wait_enqueues; }
+    void stale_skipped() { ++stale_entries; }
+    void stolen() { ++steals; }
+    void timed_out() { ++timeouts; }
+    void queue_lengths(size_t, size_t);
+
+    void write_json(OutputBuffer&) const;
+private:
+    uint64_t commands[METRICS_COMMAND_KINDS];
+    uint64_t latency_ns[METRICS_COMMAND_KINDS];
+    uint64_t histogram[METRICS_COMMAND_KINDS][METRICS_BUCKETS];
+
+    uint64_t dispatches;
+    uint64_t quantum_expirations;
+    uint64_t ready_enqueues;
+    uint64_t wait_enqueues;
+    uint64_t stale_entries;
+    uint64_t steals;
+    uint64_t timeouts;
+
+    uint64_t samples;
+    uint64_t ready_length_total;
+    uint64_t wait_length_total;
+    size_t ready_length_max;
+    size_t wait_length_max;
+};
+
+#else
+
+class Metrics
+{
+public:
+    struct Time {};
+
+    static const bool enabled = false;
+
+    Time start() const { return Time(); }
+    void command(bool, CommandType, Time) {}
+
+    void dispatched() {}
+    void quantum_expired() {}
+    void ready_enqueued() {}
+    void wait_enqueued() {}
+    void stale_skipped() {}
+    void stolen() {}
+    void timed_out() {}
+    void queue_lengths(size_t, size_t) {}
+
+    void write_json(OutputBuffer&) const {}
+};
+
+#endif //SCHEDULER_METRICS
+
+#endif //METRICS_H
@@ -0,0 +1,87 @@
+// File: mpsc_queue.hpp
+// --------------------------------------------------------
+// Class: CS 470                      Instructor: Dr. Hwang
+// Assignment: Process Scheduling     Date Assigned: 22 February 2016
+// Programmer: Evan Higgins           Date Completed: 18 March 2016
+
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <atomic>
+#include "spsc_ring.hpp"
+
+// ============================================================
+//
+// An unbounded FIFO that any number of producer threads push
+// onto and one consumer thread pops from, without locks. Nodes
+// are linked through their own next member,
+//
+//     std::atomic<T*> next;
+//
+// so nothing is allocated here. A push is a single exchange,
+// so producers never wait on each other or on the consumer.
+//
+// pop() returns nullptr when the queue is empty, and also in
+// the brief window where a producer has claimed its place but
+// not yet linked its node in; the node shows up on a later
+// pop(). Nodes come out in the order their pushes claimed
+// their places, which keeps each producer's own nodes in
+// order.
+//
+// ============================================================
+template<typename T>
+class MpscQueue
+{
+public:
+    MpscQueue() : head(&stub), tail(&stub) {
+        stub.next.store(nullptr, std::memory_order_relaxed);
+    }
+
+    void push(T * node) {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        T * previous = head.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+    }
+
+    T * pop() {
+        T * first = tail;
+        T * next = first->next.load(std::memory_order_acquire);
+
+        //The stub is only in the way.
+        if(first == &stub) {
+            if(!next)
+                return nullptr;
+            tail = next;
+            first = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+
+        if(next) {
+            tail = next;
+            return first;
+        }
+        if(first != head.load(std::memory_order_acquire))
+            return nullptr;
+
+        //first is the last node. The stub goes in behind it so
+        //it can be taken without leaving the queue headless.
+        push(&stub);
+        next = first->next.load(std::memory_order_acquire);
+        if(next) {
+            tail = next;
+            return first;
+        }
+        return nullptr;
+    }
+private:
+    //The last node pushed, written by every producer, and the
+    //next node to pop, only touched by the consumer.
+    alignas(CACHE_LINE_SIZE) std::atomic<T*> head;
+    alignas(CACHE_LINE_SIZE) T * tail;
+    T stub;
+
+    MpscQueue(const MpscQueue&);
+    MpscQueue& operator=(const MpscQueue&);
+};
+
+#endif //MPSC_QUEUE_H
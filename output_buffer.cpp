@@ -0,0 +1,103 @@
+// File: output_buffer.cpp
+// --------------------------------------------------------
+// Class: CS 470                      Instructor: Dr. Hwang
+// Assignment: Process Scheduling     Date Assigned: 22 February 2016
+// Programmer: Evan Higgins           Date Completed: 18 March 2016
+
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include "output_buffer.hpp"
+
+using namespace std;
+
+// ============================================================
+// Function: OutputBuffer(string)
+//
+// Creates (or truncates) file_name for writing, or writes to
+// stdout if file_name is "-". good() is false if the file
+// could not be opened.
+// ============================================================
+OutputBuffer::OutputBuffer(const string & file_name) :
+    buffer(OUTPUT_BLOCK_SIZE),
+    used(0)
+{
+    if(file_name == "-")
+        fd = dup(STDOUT_FILENO);
+    else
+        fd = open(file_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+}
+
+OutputBuffer::~OutputBuffer() {
+    close();
+}
+
+// ============================================================
+// Function: put_int(long long)
+//
+// Appends the decimal representation of value.
+// ============================================================
+void OutputBuffer::put_int(long long value) {
+    char digits[24];
+    char * end = digits + sizeof(digits);
+    char * begin = end;
+
+    unsigned long long magnitude = value < 0 ?
+        0ULL - static_cast<unsigned long long>(value) : value;
+    do {
+        *--begin = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while(magnitude != 0);
+
+    if(value < 0)
+        *--begin = '-';
+
+    write(begin, end - begin);
+}
+
+// ============================================================
+// Function: flush()
+//
+// Writes out everything buffered so far.
+// ============================================================
+void OutputBuffer::flush() {
+    write_fd(buffer.data(), used);
+    used = 0;
+}
+
+// ============================================================
+// Function: close()
+//
+// Flushes the buffer and closes the file. Anything written
+// after close() is discarded.
+// ============================================================
+void OutputBuffer::close() {
+    if(fd < 0)
+        return;
+    flush();
+    ::close(fd);
+    fd = -1;
+}
+
+void OutputBuffer::write_slow(const char * text, size_t length) {
+    flush();
+    if(length >= buffer.size()) {
+        write_fd(text, length);
+        return;
+    }
+    memcpy(buffer.data(), text, length);
+    used = length;
+}
+
+void OutputBuffer::write_fd(const char * text, size_t length) {
+    while(fd >= 0 && length > 0) {
+        ssize_t count = ::write(fd, text, length);
+        if(count < 0) {
+            if(errno == EINTR)
+                continue;
+            return;
+        }
+        text += count;
+        length -= count;
+    }
+}
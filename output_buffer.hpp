@@ -0,0 +1,67 @@
+// File: output_buffer.hpp
+// --------------------------------------------------------
+// Class: CS 470                      Instructor: Dr. Hwang
+// Assignment: Process Scheduling     Date Assigned: 22 February 2016
+// Programmer: Evan Higgins           Date Completed: 18 March 2016
+
+#ifndef OUTPUT_BUFFER_H
+#define OUTPUT_BUFFER_H
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#define OUTPUT_BLOCK_SIZE (1 << 16)
+
+// ============================================================
+//
+// A minimal buffered writer for simulation output. Text is
+// collected in a fixed block and handed to write(2) only when
+// the block fills up or the buffer is flushed, instead of
+// flushing on every line like std::endl does. Integers are
+// formatted by hand rather than through the ostream locale
+// machinery.
+//
+// ============================================================
+class OutputBuffer
+{
+public:
+    OutputBuffer(const std::string&);
+    ~OutputBuffer();
+
+    bool good() const { return fd >= 0; }
+
+    void put(char c) {
+        if(used == buffer.size())
+            flush();
+        buffer[used++] = c;
+    }
+
+    void write(const char * text, size_t length) {
+        if(length > buffer.size() - used) {
+            write_slow(text, length);
+            return;
+        }
+        memcpy(buffer.data() + used, text, length);
+        used += length;
+    }
+
+    void write(const char * text) { write(text, strlen(text)); }
+
+    void put_int(long long);
+
+    void flush();
+    void close();
+private:
+    int fd;
+    std::vector<char> buffer;
+    size_t used;
+
+    void write_slow(const char*, size_t);
+    void write_fd(const char*, size_t);
+
+    OutputBuffer(const OutputBuffer&);
+    OutputBuffer& operator=(const OutputBuffer&);
+};
+
+#endif //OUTPUT_BUFFER_H
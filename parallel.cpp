@@ -0,0 +1,104 @@
+// File: parallel.cpp
+// --------------------------------------------------------
+// Class: CS 470                      Instructor: Dr. Hwang
+// Assignment: Process Scheduling     Date Assigned: 22 February 2016
+// Programmer: Evan Higgins           Date Completed: 18 March 2016
+
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "parallel.hpp"
+
+using namespace std;
+
+namespace {
+
+//The jobs one thread has yet to run. The owner takes jobs off
+//the front and other threads steal them off the back.
+struct WorkQueue
+{
+    mutex lock;
+    deque<size_t> jobs;
+};
+
+bool take_front(WorkQueue & queue, size_t & job) {
+    lock_guard<mutex> guard(queue.lock);
+    if(queue.jobs.empty())
+        return false;
+    job = queue.jobs.front();
+    queue.jobs.pop_front();
+    return true;
+}
+
+bool take_back(WorkQueue & queue, size_t & job) {
+    lock_guard<mutex> guard(queue.lock);
+    if(queue.jobs.empty())
+        return false;
+    job = queue.jobs.back();
+    queue.jobs.pop_back();
+    return true;
+}
+
+}
+
+// ============================================================
+// Function: default_thread_count()
+// Returns:  unsigned
+//
+// The number of hardware threads, or 1 if it can't be found.
+// ============================================================
+unsigned default_thread_count() {
+    unsigned count = thread::hardware_concurrency();
+    return count > 0 ? count : 1;
+}
+
+// ============================================================
+// Function: parallel_for(size_t, unsigned,
+//                        const function<void(size_t)>&)
+//
+// Calls job(i) for every i below count on up to threads
+// threads, and returns once all of them are done.
+//
+// Each thread starts with its own contiguous block of jobs and
+// runs them in order, so neighbouring jobs (such as the quanta
+// of one input) tend to run on the same thread. A thread that
+// runs out steals from the far end of another thread's block,
+// which keeps one slow block from holding up the rest. With
+// one thread, or one job, everything runs on the calling
+// thread.
+// ============================================================
+void parallel_for(size_t count,
+                  unsigned threads,
+                  const function<void(size_t)> & job) {
+    if(threads > count)
+        threads = count;
+    if(threads == 0)
+        return;
+
+    vector<WorkQueue> queues(threads);
+    for(size_t i = 0; i < count; ++i)
+        queues[i * threads / count].jobs.push_back(i);
+
+    //Jobs are never added once running, so a thread that finds
+    //every queue empty is done.
+    auto worker = [&](unsigned self) {
+        size_t next;
+        for(;;) {
+            bool found = take_front(queues[self], next);
+            for(unsigned victim = 1; !found && victim < threads; ++victim)
+                found = take_back(queues[(self + victim) % threads], next);
+            if(!found)
+                return;
+            job(next);
+        }
+    };
+
+    vector<thread> pool;
+    for(unsigned i = 1; i < threads; ++i)
+        pool.push_back(thread(worker, i));
+    worker(0);
+
+    for(auto & thread : pool)
+        thread.join();
+}
@@ -0,0 +1,17 @@
+// File: parallel.hpp
+// --------------------------------------------------------
+// Class: CS 470                      Instructor: Dr. Hwang
+// Assignment: Process Scheduling     Date Assigned: 22 February 2016
+// Programmer: Evan Higgins           Date Completed: 18 March 2016
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <cstddef>
+#include <functional>
+
+unsigned default_thread_count();
+
+void parallel_for(size_t, unsigned, const std::function<void(size_t)>&);
+
+#endif //PARALLEL_H
@@ -0,0 +1,156 @@
+// File: pipeline.cpp
+// --------------------------------------------------------
+// Class: CS 470                      Instructor: Dr. Hwang
+// Assignment: Process Scheduling     Date Assigned: 22 February 2016
+// Programmer: Evan Higgins           Date Completed: 18 March 2016
+
+#include <algorithm>
+#include <iostream>
+#include <thread>
+#include "pipeline.hpp"
+#include "scheduler.hpp"
+#include "simulation.hpp"
+
+using namespace std;
+
+// ============================================================
+// Function: write_records(string&)
+//
+// Swaps records into the next free slot of the ring, so the
+// formatter gets them without a copy and the sink gets the
+// slot's old buffer back to fill.
+// ============================================================
+void PipedStateSink::write_records(string & block) {
+    string * slot = ring.acquire();
+    if(!slot)
+        return;
+    slot->swap(block);
+    ring.publish();
+}
+
+// ============================================================
+// Function: Pipeline(InputReader&, OutputBuffer&,
+//                    const RunOptions&)
+//
+// Sets up a pipeline reading input and writing to out in the
+// output mode of options. The scheduler it runs must be made
+// with the same options.
+// ============================================================
+Pipeline::Pipeline(InputReader & input, OutputBuffer & out, const RunOptions & options) :
+    input(input),
+    out(out),
+    lines(PIPELINE_BLOCKS),
+    records(PIPELINE_BLOCKS),
+    formatted(options.output_mode == OutputMode::Full &&
+              options.policy == SchedulingPolicy::RoundRobin &&
+              options.cpus == 1)
+{
+    if(formatted)
+        simulation_sink.reset(new PipedStateSink(records));
+    else
+        simulation_sink = make_sink(options, out);
+}
+
+// ============================================================
+// Function: run(Scheduler&)
+// Returns:  bool
+//
+// Runs scheduler on the input, with the parser and formatter
+// on threads of their own, and returns once all of the output
+// has been written to out. The sink is gone afterwards. Returns
+// false if the formatter couldn't make sense of the state log.
+// ============================================================
+bool Pipeline::run(Scheduler & scheduler) {
+    bool decoded = true;
+    thread parser(&Pipeline::parse, this);
+    thread formatter;
+    if(formatted)
+        formatter = thread([&]() { decoded = format(); });
+
+    PipedInput piped(lines);
+    scheduler.run(piped);
+
+    //Stops the parser as well if the run ended first.
+    lines.close();
+    parser.join();
+
+    //The sink may still hold records or output.
+    simulation_sink.reset();
+    if(formatted) {
+        records.close();
+        formatter.join();
+    }
+
+    if(!decoded)
+        cerr << "[ERROR]: The formatter could not decode the state log." << endl;
+    return decoded;
+}
+
+// ============================================================
+// Function: parse()
+//
+// The parser stage. Reads input up to and including its first
+// X, decoding every valid line the way CommandBuffer does, and
+// publishes the lines a block at a time.
+// ============================================================
+void Pipeline::parse() {
+    LineBlock * block = lines.acquire();
+    if(!block)
+        return;
+    block->text.clear();
+    block->lines.clear();
+
+    InputLine line;
+    while(input.next(line)) {
+        if(!block->lines.empty() &&
+                block->text.size() + line.length > PIPELINE_BLOCK_SIZE) {
+            lines.publish();
+            block = lines.acquire();
+            if(!block)
+                return;
+            block->text.clear();
+            block->lines.clear();
+        }
+
+        //Reserved up front, so text never moves once lines
+        //point into it.
+        if(block->lines.empty())
+            block->text.reserve(max<size_t>(PIPELINE_BLOCK_SIZE, line.length));
+        size_t offset = block->text.size();
+        block->text.append(line.text, line.length);
+        line.text = block->text.data() + offset;
+
+        //Invalid lines stay undecoded and are reported by the
+        //scheduler when it reaches them.
+        if(!line.decoded)
+            line.decoded = parse_command(line.text, line.length, line.command);
+        block->lines.push_back(line);
+
+        if(line.length == 1 && line.text[0] == 'X')
+            break;
+    }
+
+    if(!block->lines.empty())
+        lines.publish();
+    lines.close();
+}
+
+// ============================================================
+// Function: format()
+// Returns:  bool
+//
+// The formatter stage. Decodes each block of state log records
+// into Full text on out until the simulation is done. Returns
+// false if a block is malformed, though it keeps draining the
+// ring so the simulation isn't held up.
+// ============================================================
+bool Pipeline::format() {
+    StateLogDecoder decoder(out);
+    bool valid = true;
+    while(string * block = records.peek()) {
+        if(valid)
+            valid = decoder.decode_records(block->data(), block->data() + block->size());
+        records.release();
+    }
+    return valid;
+}
@@ -0,0 +1,133 @@
+// File: pipeline.hpp
+// --------------------------------------------------------
+// Class: CS 470                      Instructor: Dr. Hwang
+// Assignment: Process Scheduling     Date Assigned: 22 February 2016
+// Programmer: Evan Higgins           Date Completed: 18 March 2016
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "command.hpp"
+#include "input_reader.hpp"
+#include "output_buffer.hpp"
+#include "spsc_ring.hpp"
+#include "state_log.hpp"
+#include "state_sink.hpp"
+
+class Scheduler;
+struct RunOptions;
+
+//Bytes of input lines, and of state log records, handed from
+//one stage to the next at a time, and how many such blocks
+//can be in flight between two stages.
+#define PIPELINE_BLOCK_SIZE (1 << 16)
+#define PIPELINE_BLOCKS 8
+
+// ============================================================
+//
+// Input lines read and decoded by the parser stage, with their
+// text back to back in text.
+//
+// ============================================================
+struct LineBlock
+{
+    std::string text;
+    std::vector<InputLine> lines;
+};
+
+typedef SpscRing<LineBlock> LineRing;
+
+// ============================================================
+//
+// The simulation stage's end of the ring from the parser. It
+// hands out lines the same way InputReader::next() does, and a
+// line stays valid until the next call.
+//
+// ============================================================
+class PipedInput : public LineSource
+{
+public:
+    PipedInput(LineRing & ring) : ring(ring), block(nullptr), position(0) {}
+
+    bool next(InputLine & line) {
+        while(!block || position == block->lines.size()) {
+            if(block)
+                ring.release();
+            block = ring.peek();
+            position = 0;
+            if(!block)
+                return false;
+        }
+        line = block->lines[position++];
+        return true;
+    }
+private:
+    LineRing & ring;
+    LineBlock * block;
+    size_t position;
+};
+
+// ============================================================
+//
+// Hands the state log records of a simulation to the formatter
+// stage instead of writing them out.
+//
+// ============================================================
+class PipedStateSink : public BinaryStateSink
+{
+public:
+    PipedStateSink(SpscRing<std::string> & ring) :
+        BinaryStateSink(PIPELINE_BLOCK_SIZE), ring(ring) {}
+    ~PipedStateSink() { flush(); }
+protected:
+    void write_records(std::string&);
+private:
+    SpscRing<std::string> & ring;
+};
+
+// ============================================================
+//
+// Runs a simulation as three stages on their own threads,
+// joined by SpscRings: a parser reading and decoding the input,
+// the simulation itself, and a formatter turning the state log
+// the simulation writes back into text. Each stage only waits
+// on the others when a ring runs full or empty, so a long run
+// takes about as long as its slowest stage rather than all
+// three added up.
+//
+// The formatter regenerates text from the state log, which can
+// only describe Full output of a round robin run on one CPU.
+// Any other run keeps the parser stage and formats its own
+// output on the simulation thread.
+//
+// ============================================================
+class Pipeline
+{
+public:
+    Pipeline(InputReader&, OutputBuffer&, const RunOptions&);
+
+    //What the scheduler passed to run() has to report to.
+    StateSink & sink() { return *simulation_sink; }
+
+    bool run(Scheduler&);
+private:
+    InputReader & input;
+    OutputBuffer & out;
+
+    LineRing lines;
+    SpscRing<std::string> records;
+
+    bool formatted;
+    std::unique_ptr<StateSink> simulation_sink;
+
+    void parse();
+    bool format();
+
+    Pipeline(const Pipeline&);
+    Pipeline& operator=(const Pipeline&);
+};
+
+#endif //PIPELINE_H
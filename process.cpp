@@ -4,30 +4,39 @@
 // Assignment: Process Scheduling     Date Assigned: 22 February 2016
 // Programmer: Evan Higgins           Date Completed: 18 March 2016
 
-#include <algorithm>
 #include "process.hpp"
 
 using namespace std;
 
-Process::Process(int PID, int burst, weak_ptr<Process> parent) {
-    this->parent = parent;
-    this->remaining_burst = burst;
-    this->PID = PID;
-    this->remaining_quantum = 0;
-    this->on_delete = [](Process& p){};
-}
-
-Process::Process(int PID,
-                 int burst,
-                 weak_ptr<Process> parent,
-                 function<void(Process&)> on_delete) :
-    Process(PID, burst, parent)
+Process::Process(int PID, int burst, ProcessHandle parent) :
+    PID(PID),
+    remaining_burst(burst),
+    remaining_quantum(0),
+    event_id(0),
+    priority(0),
+    flags(0),
+    cpu(0),
+    handle(IDLE_HANDLE),
+    parent(parent),
+    first_child(NO_SLOT),
+    next_sibling(NO_SLOT),
+    prev_sibling(NO_SLOT)
 {
-    this->on_delete = on_delete;
+    for(auto & link : links)
+        link = ProcessLinks{ NO_SLOT, NO_SLOT };
 }
 
-Process::~Process() {
-    on_delete(*this);
+// ============================================================
+// Function: idle_process()
+// Returns:  Process
+//
+// The idle process: PID 0, never runs out of burst or quantum
+// and ignores ticks.
+// ============================================================
+Process Process::idle_process() {
+    Process idle(IDLE_PID, 0, IDLE_HANDLE);
+    idle.flags = IDLE;
+    return idle;
 }
 
 // ============================================================
@@ -36,33 +45,27 @@ Process::~Process() {
 // Advances the processes time step by one unit.
 // ============================================================
 void Process::tick() {
+    if(is_idle())
+        return;
     --remaining_burst;
     --remaining_quantum;
 }
 
 // ============================================================
-// Function: add_child(shared_ptr<Process>
+// Function: advance(int)
 //
-// Adds a new shared_ptr reference to the processes list of
-// children.
+// Same as ticks calls to tick() on a process that isn't idle.
 // ============================================================
-void Process::add_child(shared_ptr<Process> child) {
-    if(child)
-        children.push_back(child);
+void Process::advance(int ticks) {
+    remaining_burst -= ticks;
+    remaining_quantum -= ticks;
 }
 
-// ============================================================
-// Function: remove_child(Process&)
-//
-// Removes all children with the same PID as child.
-// ============================================================
-void Process::remove_child(Process & child) {
-    children.erase(
-            remove_if(children.begin(), children.end(),
-                        [&](shared_ptr<Process> p) {
-                            return *p == child;
-                        }),
-            children.end());
+void Process::set_ready(bool ready) {
+    if(ready)
+        flags |= READY;
+    else
+        flags &= ~READY;
 }
 
 // ============================================================
@@ -72,7 +75,7 @@ void Process::remove_child(Process & child) {
 // ============================================================
 void Process::wait_on(int event_id) {
     this->event_id = event_id;
-    waiting_for_event = true;
+    flags |= WAITING;
 }
 
 // ============================================================
@@ -82,95 +85,69 @@ void Process::wait_on(int event_id) {
 // Returns true if this is waiting on the provided event_id.
 // ============================================================
 bool Process::receive_event(int event_id) {
-    if(waiting_for_event && this->event_id == event_id) {
-        waiting_for_event = false;
+    if((flags & WAITING) && this->event_id == event_id) {
+        flags &= ~WAITING;
         return true;
     }
     return false;
 }
 
 // ============================================================
-// Function: owns(Process&)
-// Returns:  bool
+// Function: save(SnapshotWriter&)
 //
-// A process P 'owns' process Q iff:
-//  P has the same PID as Q
-//  OR
-//  One of P's children 'owns' Q. 
-// ============================================================
-bool Process::owns(Process & p) const {
-    if(*this == p)
-        return true;
-
-    for(auto &child : children) {
-        if(child->owns(p))
-            return true;
-    }
-
-    return false;
-}
-
-bool Process::owns(int PID) const {
-    if(get_PID() == PID)
-        return true;
-
-    for(auto &child : children) {
-        if(child->owns(PID))
-            return true;
+// Writes every field, links included, to a snapshot.
+// ============================================================
+void Process::save(SnapshotWriter & out) const {
+    out.put_signed(PID);
+    out.put_signed(remaining_burst);
+    out.put_signed(remaining_quantum);
+    out.put_signed(event_id);
+    out.put_signed(priority);
+    out.put(flags);
+    out.put(cpu);
+    save_handle(out, handle);
+    save_handle(out, parent);
+    out.put_index(first_child);
+    out.put_index(next_sibling);
+    out.put_index(prev_sibling);
+    for(auto & link : links) {
+        out.put_index(link.prev);
+        out.put_index(link.next);
     }
-
-    return false;
 }
 
 // ============================================================
-// Function: for_each_child
+// Function: restore(SnapshotReader&)
 //
-// I didn't want to provide an accessor to this->children because
-// the lifetime of processes are dependent on the shared_ptr held
-// by their parents. So it opens up possibilities for a memory
-// leak if these references are external to Process. So
-// for_each_child gives me the ability to operate on the process
-// graph without the possibility of a memory leak.
-//
-// This applies func to each child of this and recursively calls
-// itself down the tree until it finds a node that matches the
-// predicate.
-// ============================================================
-void Process::search_children_until(function<bool(Process&)> pred) const {
-    for(auto &child : children) {
-        //Stop recursing when the predicate is met
-        if(pred(*child))
-            return;
-        child->search_children_until(pred);
-    }
-}
-
-// ============================================================
-// Function: terminate();
-//
-// Deletes the shared_ptr to this held by parent. This results
-// in a cascading termination of all of this's child processes.
-// ============================================================
-void Process::terminate() {
-    auto shared_parent = parent.lock();
-    if(shared_parent) {
-        shared_parent->remove_child(*this);
+// Reads back what save() wrote. The links are not checked
+// here; the ProcessTable checks them once every slot is back.
+// ============================================================
+void Process::restore(SnapshotReader & in) {
+    PID = in.get_int();
+    remaining_burst = in.get_int();
+    remaining_quantum = in.get_int();
+    event_id = in.get_int();
+    priority = in.get_int();
+    flags = static_cast<uint8_t>(in.get());
+    cpu = static_cast<uint16_t>(in.get());
+    handle = restore_handle(in);
+    parent = restore_handle(in);
+    first_child = in.get_index();
+    next_sibling = in.get_index();
+    prev_sibling = in.get_index();
+    for(auto & link : links) {
+        link.prev = in.get_index();
+        link.next = in.get_index();
     }
 }
 
 ostream& operator<<(ostream & out, const Process & proc) {
-    proc.print(out);
+    out << "PID " << proc.PID;
+    if(!proc.is_idle())
+        out << " " << proc.remaining_burst;
     return out;
 }
 
-void Process::print(ostream & out) const {
-    out << "PID " << this->PID << " " << this->remaining_burst;
-}
-
-void IdleProcess::print(ostream & out) const {
-    out << "PID " << IDLE_PID;
-}
-
 // ============================================================
 // Function: operator==(Process, Process)
 // Returns:  bool
@@ -180,3 +157,26 @@ void IdleProcess::print(ostream & out) const {
 bool operator==(const Process & lhs, const Process & rhs) {
     return lhs.get_PID() == rhs.get_PID();
 }
+
+bool operator==(const ProcessHandle & lhs, const ProcessHandle & rhs) {
+    return lhs.index == rhs.index && lhs.generation == rhs.generation;
+}
+
+bool operator!=(const ProcessHandle & lhs, const ProcessHandle & rhs) {
+    return !(lhs == rhs);
+}
+
+void save_handle(SnapshotWriter & out, ProcessHandle handle) {
+    out.put_index(handle.index);
+    out.put(handle.generation);
+}
+
+ProcessHandle restore_handle(SnapshotReader & in) {
+    ProcessHandle handle;
+    handle.index = in.get_index();
+    uint64_t generation = in.get();
+    if(generation > UINT32_MAX)
+        in.fail();
+    handle.generation = static_cast<uint32_t>(generation);
+    return handle;
+}
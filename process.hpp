@@ -9,119 +9,184 @@
 
 #define IDLE_PID 0
 
+#include <cstdint>
 #include <iostream>
-#include <vector>
+#include "snapshot.hpp"
 
 // ============================================================
 //
-// The model I settled on to represent parent/child relationships
-// between processes leverages std::shared_ptr and std::weak_ptr.
-// Each process maintains a vector of shared_ptrs to its children
-// and each child maintains a weak_ptr to its parent. Any external
-// references to processes should be kept as weak_ptrs. As long
-// as this rule is followed all that is necessary to terminate a
-// process and its children is to eliminate the shared_ptr the
-// process's parent holds. By the semantics of shared_ptr the
-// process will then be destructed, which calls this->children's
-// destructor which in turn destructs all the shared_ptr to its
-// children and so on. The termination cascades down the object
-// graph terminating all child processes.
+// A ProcessHandle names a slot in the ProcessTable together
+// with the generation the slot was on when the process was
+// created. Every time a slot is released its generation is
+// bumped, so a handle that outlives its process no longer
+// matches and is reported as stale by the table. This plays
+// the role weak_ptr::lock used to play without a control
+// block or reference counting.
 //
-// I arrived at this model after realizing that it made the most
-// sense to use heap-allocated processes. It
-// is doable to maintain a vector of Process objects in the
-// scheduler and keep a list of child pids within a process, but
-// that requires some linear time (with respect to # of processes)
-// pid_lookup(int) function. And if Processes are stored by value
-// in a vector then processes can't maintain direct references
-// to their children/parent.
+// ============================================================
+struct ProcessHandle
+{
+    uint32_t index;
+    uint32_t generation;
+};
+
+bool operator==(const ProcessHandle&, const ProcessHandle&);
+bool operator!=(const ProcessHandle&, const ProcessHandle&);
+
+void save_handle(SnapshotWriter&, ProcessHandle);
+ProcessHandle restore_handle(SnapshotReader&);
+
+//The idle process is not stored in a table slot. This handle
+//always resolves to it and is the parent of top level processes.
+const ProcessHandle IDLE_HANDLE = { UINT32_MAX, 0 };
+
+//Ends the child lists and ProcessLists kept in Process.
+const uint32_t NO_SLOT = UINT32_MAX;
+
+//The links a process has for being on a ProcessList (see
+//process_list.hpp). It can be on one list of each kind at once:
+//the ready or wait queue, and the waiters of its event.
+enum ProcessLinkKind
+{
+    QUEUE_LINKS,
+    EVENT_LINKS,
+    LINK_KINDS
+};
+
+struct ProcessLinks
+{
+    uint32_t prev;
+    uint32_t next;
+};
+
+// ============================================================
+//
+// Processes live by value in a ProcessTable (see
+// process_table.hpp). Each process keeps a handle to its
+// parent and its children are linked through their slots, and
+// anything outside the table refers to processes by handle as
+// well.
 //
 // My first design used vectors of raw pointers to processes.
 // This was very difficult to manage and ensure that no
 // dangling pointers showed up and make sure there were no
 // memory leaks. Next I tried using exclusively shared_ptr.
 // This made it very slow to delete processes because for each
-// child process the ready/wait queue had to be searched.
-// Ultimately I settled on a mix of weak/shared pointers which
-// establishes an "ownership" of parent->child and makes for
-// a more consistent mangament of processes.
+// child process the ready/wait queue had to be searched. After
+// that I used a mix of weak/shared pointers which established
+// an "ownership" of parent->child, but it paid for a heap
+// allocation and a reference count per process and a lock()
+// on every queue access.
+//
+// Handles keep the parent->child ownership and the cheap
+// termination of the weak_ptr model: terminating a process
+// releases its slot and every slot in its subtree, and any
+// handle to them that is still around simply goes stale. The
+// ready and wait queues are threaded through the processes
+// themselves, so a released process unlinks itself in O(1)
+// rather than lingering in them.
+//
+// A Process is a plain record with no virtual functions and
+// nothing on the heap, so a table of millions of them is one
+// contiguous allocation. The idle process is a Process marked
+// as idle rather than a subclass; the few operations that
+// treat it differently check the mark. Termination messages
+// are the table's job (see TerminationSink).
 //
 // ============================================================
 class Process
 {
 public:
-    Process(int, int, std::weak_ptr<Process>);
-    Process(int, int, std::weak_ptr<Process>, std::function<void(Process&)>);
-    ~Process();
+    Process(int, int, ProcessHandle);
+
+    static Process idle_process();
 
     /* Accessors */
     int get_PID() const { return PID; }
+    int get_remaining_burst() const { return remaining_burst; }
     int get_remaining_quantum() const { return remaining_quantum; }
     int get_waiting_on() const { return event_id; }
-    std::weak_ptr<Process> get_parent() const { return parent; }
+    int get_priority() const { return priority; }
+    ProcessHandle get_handle() const { return handle; }
+    ProcessHandle get_parent() const { return parent; }
+    unsigned get_cpu() const { return cpu; }
 
     void set_quantum(int q) { remaining_quantum = q; };
+    void set_priority(int p) { priority = p; }
+    void set_cpu(unsigned c) { cpu = static_cast<uint16_t>(c); }
 
-    virtual bool is_idle() const { return false; }
-    virtual bool burst_remaining() const { return remaining_burst > 0; }
-    virtual bool quantum_remaining() const { return remaining_quantum > 0; }
-    virtual bool is_exiting() const { return remaining_burst <= 0; }
+    bool is_idle() const { return flags & IDLE; }
+    bool burst_remaining() const { return is_idle() || remaining_burst > 0; }
+    bool quantum_remaining() const { return is_idle() || remaining_quantum > 0; }
+    bool is_exiting() const { return !is_idle() && remaining_burst <= 0; }
 
-    virtual void tick();
+    //Set while the process is on the ready queue.
+    bool is_ready() const { return flags & READY; }
+    void set_ready(bool);
 
-    void wait_on(int);
-    bool receive_event(int);
-
-    void add_child(std::shared_ptr<Process>);
-    void remove_child(Process&);
+    bool is_waiting() const { return flags & WAITING; }
 
-    bool owns(Process&) const;
-    bool owns(int) const;
+    void tick();
+    void advance(int);
 
-    //void for_each_child(std::function<void(Process&)>) const;
-    void search_children_until(std::function<bool(Process&)>) const;
+    void wait_on(int);
+    bool receive_event(int);
 
-    void terminate();
+    void save(SnapshotWriter&) const;
+    void restore(SnapshotReader&);
 
     friend std::ostream& operator<<(std::ostream&, const Process&);
+    friend class ProcessTable;
+    friend class ProcessList;
 private:
+    enum Flags : uint8_t
+    {
+        IDLE = 1,
+        WAITING = 2,
+        READY = 4
+    };
+
     int PID;
     int remaining_burst;
     int remaining_quantum;
-    bool waiting_for_event;
     int event_id;
 
-    //Executed in the destructor and passed *this.
-    //Used for outputing termination message
-    std::function<void(Process &)> on_delete;
+    //Only looked at by the priority based scheduling policies.
+    //Lower runs first.
+    int priority;
 
-    std::weak_ptr<Process> parent;
+    uint8_t flags;
 
-    std::vector< std::shared_ptr<Process> > children;
+    //The CPU whose ready queue the process is on, or that it is
+    //running on or last ran on. Fits in the padding after flags.
+    uint16_t cpu;
 
-    virtual void print(std::ostream &) const;
-};
+    //Set by the ProcessTable to the handle of this process's slot.
+    ProcessHandle handle;
+    ProcessHandle parent;
 
-// ============================================================
-//
-// This is essentially the Null Object pattern. IdleProcess
-// overrides methods to generally return some value meaning
-// the process is not complete.
-//
-// ============================================================
-class IdleProcess : public Process
-{
-public:
-    IdleProcess() : Process(0, 0, std::weak_ptr<Process>()){}
-    void tick() {}
-    bool is_idle() const { return true; }
-    bool burst_remaining() const { return true; }
-    bool quantum_remaining() const { return true; }
-    bool is_exiting() const { return false; }
-private:
-    void print(std::ostream &) const;
+    //Children are a doubly linked list through their slots,
+    //newest first, maintained by the ProcessTable. A child is
+    //always live while it is linked, so slot indices are enough.
+    //NO_SLOT ends the list.
+    uint32_t first_child;
+    uint32_t next_sibling;
+    uint32_t prev_sibling;
+
+    ProcessLinks links[LINK_KINDS];
 };
 
+//CPUs a simulation may have, as many as Process::cpu can name.
+#define MAX_CPUS 65536
+
+//Bytes a Process may take up. A process really costs the
+//SLOT_SIZE_BUDGET of its ProcessTable slot, which holds the
+//table's own bookkeeping as well.
+#define PROCESS_SIZE_BUDGET 72
+
+static_assert(sizeof(Process) <= PROCESS_SIZE_BUDGET,
+              "Process is over its size budget");
+
 bool operator==(const Process&, const Process&);
 
 #endif //PROCESS_H
@@ -0,0 +1,78 @@
+// File: process_list.cpp
+// --------------------------------------------------------
+// Class: CS 470                      Instructor: Dr. Hwang
+// Assignment: Process Scheduling     Date Assigned: 22 February 2016
+// Programmer: Evan Higgins           Date Completed: 18 March 2016
+
+#include "process_list.hpp"
+
+using namespace std;
+
+ProcessList::ProcessList(ProcessTable & table, ProcessLinkKind kind) :
+    table(table),
+    kind(kind),
+    head(NO_SLOT),
+    tail(NO_SLOT),
+    count(0)
+{
+}
+
+// ============================================================
+// Function: push_back(Process&)
+//
+// Links process in at the back of the list.
+// ============================================================
+void ProcessList::push_back(Process & process) {
+    uint32_t index = process.get_handle().index;
+    ProcessLinks & links = process.links[kind];
+    links.prev = tail;
+    links.next = NO_SLOT;
+    if(tail != NO_SLOT)
+        table.at(tail).links[kind].next = index;
+    else
+        head = index;
+    tail = index;
+    ++count;
+}
+
+// ============================================================
+// Function: unlink(Process&)
+//
+// Takes process, which must be on this list, off it.
+// ============================================================
+void ProcessList::unlink(Process & process) {
+    ProcessLinks & links = process.links[kind];
+    if(links.prev != NO_SLOT)
+        table.at(links.prev).links[kind].next = links.next;
+    else
+        head = links.next;
+    if(links.next != NO_SLOT)
+        table.at(links.next).links[kind].prev = links.prev;
+    else
+        tail = links.prev;
+    links = ProcessLinks{ NO_SLOT, NO_SLOT };
+    --count;
+}
+
+void ProcessList::save(SnapshotWriter & out) const {
+    out.put_index(head);
+    out.put_index(tail);
+    out.put(count);
+}
+
+// ============================================================
+// Function: restore(SnapshotReader&)
+// Returns:  bool
+//
+// Reads back what save() wrote. The links between members were
+// restored with the processes, so only the ends are read here.
+// The table must be restored first.
+// ============================================================
+bool ProcessList::restore(SnapshotReader & in) {
+    head = in.get_index();
+    tail = in.get_index();
+    count = in.get();
+    return in.good() && table.valid_index(head) && table.valid_index(tail) &&
+           count <= table.slot_count() &&
+           (head == NO_SLOT) == (count == 0) && (tail == NO_SLOT) == (count == 0);
+}
@@ -0,0 +1,54 @@
+// File: process_list.hpp
+// --------------------------------------------------------
+// Class: CS 470                      Instructor: Dr. Hwang
+// Assignment: Process Scheduling     Date Assigned: 22 February 2016
+// Programmer: Evan Higgins           Date Completed: 18 March 2016
+
+#ifndef PROCESS_LIST_H
+#define PROCESS_LIST_H
+
+#include "process_table.hpp"
+
+// ============================================================
+//
+// A FIFO of processes linked through the processes themselves,
+// using one of their sets of ProcessLinks. Pushing, popping and
+// unlinking any member are all O(1) and allocate nothing. A
+// process must be unlinked before its slot is released; a
+// process can't be on two lists using the same links.
+//
+// ============================================================
+class ProcessList
+{
+public:
+    ProcessList(ProcessTable&, ProcessLinkKind);
+
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+
+    const Process & front() const { return table.at(head); }
+    Process & front() { return table.at(head); }
+
+    void push_back(Process&);
+    void unlink(Process&);
+
+    void save(SnapshotWriter&) const;
+    bool restore(SnapshotReader&);
+
+    //Visits every process on the list from the front.
+    template<typename Visitor>
+    void for_each(Visitor visit) const {
+        for(uint32_t index = head; index != NO_SLOT;
+                index = table.at(index).links[kind].next)
+            visit(table.at(index));
+    }
+private:
+    ProcessTable & table;
+    ProcessLinkKind kind;
+
+    uint32_t head;
+    uint32_t tail;
+    size_t count;
+};
+
+#endif //PROCESS_LIST_H
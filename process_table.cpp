@@ -0,0 +1,379 @@
+// File: process_table.cpp
+// --------------------------------------------------------
+// Class: CS 470                      Instructor: Dr. Hwang
+// Assignment: Process Scheduling     Date Assigned: 22 February 2016
+// Programmer: Evan Higgins           Date Completed: 18 March 2016
+
+#include <algorithm>
+#include "process_table.hpp"
+
+using namespace std;
+
+ProcessTable::ProcessTable(TerminationSink & termination_sink) :
+    idle_process(Process::idle_process()),
+    termination_sink(termination_sink),
+    reclaim_budget(0),
+    epoch(1)
+{
+}
+
+// ============================================================
+// Function: create(int, int, ProcessHandle)
+// Returns:  ProcessHandle
+//
+// Places a new process in a free slot (or a new one if none
+// are free) and adds it to parent's children.
+// ============================================================
+ProcessHandle ProcessTable::create(int PID, int burst, ProcessHandle parent) {
+    uint32_t index;
+    if(!free_slots.empty()) {
+        index = free_slots.back();
+        free_slots.pop_back();
+        slots[index].process = Process(PID, burst, parent);
+        slots[index].checked_epoch = 0;
+    } else {
+        index = slots.size();
+        slots.push_back(Slot{ Process(PID, burst, parent), 0, false, false, 0 });
+    }
+
+    ProcessHandle handle = { index, slots[index].generation };
+    slots[index].process.handle = handle;
+    link_child(*get(parent), index);
+    return handle;
+}
+
+// ============================================================
+// Function: reserve(size_t)
+//
+// Makes room for count more creates, past what the free list
+// already covers, so a batch of them grows slots at most once.
+// Capacity still at least doubles, so a run of small batches
+// costs no more than the same creates one at a time.
+// ============================================================
+void ProcessTable::reserve(size_t count) {
+    if(count <= free_slots.size())
+        return;
+    size_t needed = slots.size() + count - free_slots.size();
+    if(needed > slots.capacity())
+        slots.reserve(max(needed, 2 * slots.capacity()));
+}
+
+// ============================================================
+// Function: link_child(Process&, uint32_t)
+//
+// Puts the process in slot child at the head of parent's
+// children.
+// ============================================================
+void ProcessTable::link_child(Process & parent, uint32_t child) {
+    Process & process = slots[child].process;
+    process.next_sibling = parent.first_child;
+    process.prev_sibling = NO_SLOT;
+    if(parent.first_child != NO_SLOT)
+        slots[parent.first_child].process.prev_sibling = child;
+    parent.first_child = child;
+}
+
+// ============================================================
+// Function: unlink_child(Process&, uint32_t)
+//
+// Takes the process in slot child out of parent's children.
+// ============================================================
+void ProcessTable::unlink_child(Process & parent, uint32_t child) {
+    Process & process = slots[child].process;
+    if(process.prev_sibling != NO_SLOT)
+        slots[process.prev_sibling].process.next_sibling = process.next_sibling;
+    else
+        parent.first_child = process.next_sibling;
+    if(process.next_sibling != NO_SLOT)
+        slots[process.next_sibling].process.prev_sibling = process.prev_sibling;
+    process.next_sibling = NO_SLOT;
+    process.prev_sibling = NO_SLOT;
+}
+
+// ============================================================
+// Function: get(ProcessHandle)
+// Returns:  Process*
+//
+// Resolves a handle to its process. Returns nullptr if the
+// process the handle referred to has since been terminated.
+// IDLE_HANDLE always resolves to the idle process.
+//
+// While a terminated subtree is waiting to be reclaimed its
+// processes are still in their slots, so they are checked for
+// a terminated ancestor as well.
+// ============================================================
+Process* ProcessTable::get(ProcessHandle handle) {
+    if(handle == IDLE_HANDLE)
+        return &idle_process;
+
+    if(handle.index >= slots.size())
+        return nullptr;
+
+    Slot & slot = slots[handle.index];
+    if(slot.generation != handle.generation || slot.dead)
+        return nullptr;
+
+    if(reclaim_pending() && has_dead_ancestor(handle.index))
+        return nullptr;
+
+    return &slot.process;
+}
+
+const Process* ProcessTable::get(ProcessHandle handle) const {
+    return const_cast<ProcessTable*>(this)->get(handle);
+}
+
+// ============================================================
+// Function: has_dead_ancestor(uint32_t)
+// Returns:  bool
+//
+// Whether any ancestor of the live process in slot index is
+// dead or already released. The walk up stops at the first
+// slot checked in this epoch, and the answer is then left on
+// every slot on the way so later lookups stop sooner.
+// ============================================================
+bool ProcessTable::has_dead_ancestor(uint32_t index) {
+    bool doomed = false;
+    uint32_t top = index;
+    while(slots[top].checked_epoch != epoch) {
+        ProcessHandle parent = slots[top].process.get_parent();
+        if(parent == IDLE_HANDLE)
+            break;
+        const Slot & parent_slot = slots[parent.index];
+        if(parent_slot.generation != parent.generation || parent_slot.dead) {
+            doomed = true;
+            break;
+        }
+        top = parent.index;
+    }
+    if(slots[top].checked_epoch == epoch)
+        doomed = slots[top].doomed;
+
+    for(uint32_t slot = index; ; slot = slots[slot].process.get_parent().index) {
+        slots[slot].doomed = doomed;
+        slots[slot].checked_epoch = epoch;
+        if(slot == top)
+            break;
+    }
+    return doomed;
+}
+
+// ============================================================
+// Function: advance_epoch()
+//
+// Forgets every answer has_dead_ancestor() has left. When the
+// counter wraps the slots are cleared instead, so an old
+// checked_epoch can never match again.
+// ============================================================
+void ProcessTable::advance_epoch() {
+    if(++epoch == 0) {
+        for(Slot & slot : slots)
+            slot.checked_epoch = 0;
+        epoch = 1;
+    }
+}
+
+// ============================================================
+// Function: owns(ProcessHandle, ProcessHandle)
+// Returns:  bool
+//
+// A process P 'owns' process Q iff:
+//  P is Q
+//  OR
+//  P is an ancestor of Q.
+//
+// Walking up Q's parent chain only costs the depth of Q rather
+// than the size of P's subtree. The idle process owns every
+// live process.
+// ============================================================
+bool ProcessTable::owns(ProcessHandle owner, ProcessHandle handle) const {
+    if(!get(handle))
+        return false;
+
+    if(owner == IDLE_HANDLE)
+        return true;
+
+    while(handle != IDLE_HANDLE) {
+        if(handle == owner)
+            return true;
+        handle = slots[handle.index].process.get_parent();
+    }
+
+    return false;
+}
+
+// ============================================================
+// Function: terminate(ProcessHandle)
+//
+// Removes the process from its parent's children and marks it
+// dead, which makes its whole subtree unreachable. The subtree
+// is released right away unless a reclaim budget is set. The
+// idle process is never terminated.
+// ============================================================
+void ProcessTable::terminate(ProcessHandle handle) {
+    if(handle == IDLE_HANDLE)
+        return;
+
+    Process * process = get(handle);
+    if(!process)
+        return;
+
+    unlink_child(*get(process->get_parent()), handle.index);
+    slots[handle.index].dead = true;
+    advance_epoch();
+    pending_roots.push_back(handle);
+
+    if(reclaim_budget == 0)
+        reclaim_all();
+}
+
+// ============================================================
+// Function: reclaim()
+//
+// Releases up to reclaim_budget terminated processes.
+// ============================================================
+void ProcessTable::reclaim() {
+    for(size_t i = 0; i < reclaim_budget && release_next(); ++i);
+}
+
+// ============================================================
+// Function: reclaim_all()
+//
+// Releases every terminated process still waiting on a slot.
+// ============================================================
+void ProcessTable::reclaim_all() {
+    while(release_next());
+}
+
+bool ProcessTable::reclaim_pending() const {
+    return !pending_roots.empty() || !release_stack.empty();
+}
+
+// ============================================================
+// Function: release_next()
+// Returns:  bool
+//
+// Notifies the termination sink of the next terminated process,
+// queues its children and frees its slot. Returns false once
+// nothing is left to release.
+//
+// Subtrees are released in the order they were terminated.
+// Children are linked newest first, and a stack entry goes on
+// to the next older sibling only once its own subtree is done,
+// so termination messages come out parent first followed by
+// the children in reverse order of creation.
+// ============================================================
+bool ProcessTable::release_next() {
+    if(release_stack.empty()) {
+        if(pending_roots.empty())
+            return false;
+        release_stack.push_back(pending_roots.front().index);
+        pending_roots.pop_front();
+    }
+
+    uint32_t index = release_stack.back();
+    release_stack.pop_back();
+
+    Slot & slot = slots[index];
+    slot.dead = true;
+    termination_sink.terminated(slot.process);
+
+    if(slot.process.next_sibling != NO_SLOT)
+        release_stack.push_back(slot.process.next_sibling);
+    if(slot.process.first_child != NO_SLOT)
+        release_stack.push_back(slot.process.first_child);
+
+    ++slot.generation;
+    slot.dead = false;
+    free_slots.push_back(index);
+    return true;
+}
+
+// ============================================================
+// Function: save(SnapshotWriter&)
+//
+// Writes every slot, free ones included, and the state of any
+// reclaim in progress. The reclaim budget is left to the
+// scheduler.
+// ============================================================
+void ProcessTable::save(SnapshotWriter & out) const {
+    out.put(slots.size());
+    for(auto & slot : slots) {
+        out.put(slot.generation);
+        out.put(slot.dead);
+        slot.process.save(out);
+    }
+
+    out.put(free_slots.size());
+    for(uint32_t index : free_slots)
+        out.put_index(index);
+
+    out.put_index(idle_process.first_child);
+
+    out.put(pending_roots.size());
+    for(auto & handle : pending_roots)
+        save_handle(out, handle);
+
+    out.put(release_stack.size());
+    for(uint32_t index : release_stack)
+        out.put_index(index);
+}
+
+// ============================================================
+// Function: restore(SnapshotReader&)
+// Returns:  bool
+//
+// Replaces the table with one read back from a snapshot.
+// Returns false if the snapshot is malformed or any of its
+// links point outside the table.
+// ============================================================
+bool ProcessTable::restore(SnapshotReader & in) {
+    slots.clear();
+    size_t count = in.get_count();
+    for(size_t i = 0; i < count && in.good(); ++i) {
+        Slot slot = { Process(0, 0, IDLE_HANDLE), 0, false, false, 0 };
+        uint64_t generation = in.get();
+        if(generation > UINT32_MAX)
+            in.fail();
+        slot.generation = static_cast<uint32_t>(generation);
+        slot.dead = in.get() != 0;
+        slot.process.restore(in);
+        slots.push_back(slot);
+    }
+
+    free_slots.resize(in.get_count());
+    for(auto & index : free_slots)
+        index = in.get_index();
+
+    idle_process.first_child = in.get_index();
+
+    pending_roots.resize(in.get_count());
+    for(auto & handle : pending_roots)
+        handle = restore_handle(in);
+
+    release_stack.resize(in.get_count());
+    for(auto & index : release_stack)
+        index = in.get_index();
+
+    if(!in.good())
+        return false;
+
+    bool valid = valid_index(idle_process.first_child);
+    for(auto & slot : slots) {
+        const Process & process = slot.process;
+        valid = valid && valid_index(process.handle.index) &&
+                valid_index(process.parent.index) &&
+                valid_index(process.first_child) &&
+                valid_index(process.next_sibling) &&
+                valid_index(process.prev_sibling);
+        for(auto & link : process.links)
+            valid = valid && valid_index(link.prev) && valid_index(link.next);
+    }
+    for(uint32_t index : free_slots)
+        valid = valid && index < slots.size();
+    for(auto & handle : pending_roots)
+        valid = valid && handle.index < slots.size();
+    for(uint32_t index : release_stack)
+        valid = valid && index < slots.size();
+    return valid;
+}
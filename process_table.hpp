@@ -0,0 +1,147 @@
+// File: process_table.hpp
+// --------------------------------------------------------
+// Class: CS 470                      Instructor: Dr. Hwang
+// Assignment: Process Scheduling     Date Assigned: 22 February 2016
+// Programmer: Evan Higgins           Date Completed: 18 March 2016
+
+#ifndef PROCESS_TABLE_H
+#define PROCESS_TABLE_H
+
+#include <deque>
+#include <vector>
+#include "process.hpp"
+
+//Bytes a ProcessTable slot may take up: its Process, and a
+//generation, two flags and the epoch has_dead_ancestor()
+//last checked it in.
+#define SLOT_SIZE_BUDGET (PROCESS_SIZE_BUDGET + 16)
+
+// ============================================================
+//
+// Told about every process the table releases, right before
+// its slot is freed. One sink serves the whole table, so
+// processes don't each carry a callback.
+//
+// ============================================================
+class TerminationSink
+{
+public:
+    virtual void terminated(Process&) = 0;
+protected:
+    ~TerminationSink() {}
+};
+
+// ============================================================
+//
+// ProcessTable owns every process in the simulation. Processes
+// are stored contiguously in slots and are handed out as
+// ProcessHandles. Released slots go on a free list and are
+// reused by later creates, so a steady stream of create and
+// terminate commands stops allocating once the table has grown
+// to the peak number of live processes.
+//
+// Slots may move when the table grows, so a Process& obtained
+// from get() must not be held across a call to create().
+//
+// Terminated subtrees are torn down with an explicit stack
+// rather than recursion, so arbitrarily deep process chains
+// can be terminated. By default a subtree is released as soon
+// as it is terminated. With a reclaim budget set, terminate()
+// only marks the root of the subtree dead and the processes
+// are released at most budget at a time by reclaim(), which
+// the scheduler calls once per tick. Until then processes in
+// the subtree resolve as stale. get() finds that out by walking
+// the parent chain, but only as far as the first slot already
+// checked since the last terminate(), and leaves the answer on
+// every slot it passed. Each slot is walked at most once per
+// terminate(), so lookups stay O(1) amortized however deep the
+// chain is. Termination notifications come out in the same
+// order either way.
+//
+// ============================================================
+class ProcessTable
+{
+public:
+    ProcessTable(TerminationSink&);
+
+    ProcessHandle create(int, int, ProcessHandle);
+    void reserve(size_t);
+
+    Process* get(ProcessHandle);
+    const Process* get(ProcessHandle) const;
+
+    //The process in a slot, terminated or not, for following
+    //the links threaded through the table. The idle process
+    //has no slot and is never linked.
+    Process & at(uint32_t index) { return slots[index].process; }
+    const Process & at(uint32_t index) const { return slots[index].process; }
+
+    bool owns(ProcessHandle, ProcessHandle) const;
+
+    void terminate(ProcessHandle);
+
+    void set_reclaim_budget(size_t budget) { reclaim_budget = budget; }
+    void reclaim();
+    void reclaim_all();
+    bool reclaim_pending() const;
+
+    size_t live_count() const { return slots.size() - free_slots.size(); }
+    size_t slot_count() const { return slots.size(); }
+
+    //Whether index is NO_SLOT or names a slot, for checking
+    //links read back from a snapshot.
+    bool valid_index(uint32_t index) const {
+        return index == NO_SLOT || index < slots.size();
+    }
+
+    void save(SnapshotWriter&) const;
+    bool restore(SnapshotReader&);
+private:
+    struct Slot
+    {
+        Process process;
+        uint32_t generation;
+        //Set on the root of a terminated subtree that has not
+        //been released yet, and on each process as it is released.
+        bool dead;
+
+        //Whether the slot has a dead ancestor, as found by get()
+        //when epoch was checked_epoch.
+        bool doomed;
+        uint32_t checked_epoch;
+    };
+
+    static_assert(sizeof(Slot) <= SLOT_SIZE_BUDGET,
+                  "A ProcessTable slot is over its size budget");
+
+    std::vector<Slot> slots;
+    std::vector<uint32_t> free_slots;
+
+    Process idle_process;
+    TerminationSink & termination_sink;
+
+    //Maximum number of processes reclaim() releases per call.
+    //0 releases terminated subtrees immediately.
+    size_t reclaim_budget;
+
+    //Roots of terminated subtrees waiting to be released, in
+    //the order they were terminated.
+    std::deque<ProcessHandle> pending_roots;
+
+    //Processes of the subtree currently being released. Each
+    //entry stands for itself and its older siblings.
+    std::vector<uint32_t> release_stack;
+
+    //Advanced by every terminate(), which is the only thing
+    //that can doom a live process. Never 0, so a slot with a
+    //checked_epoch of 0 has not been checked.
+    uint32_t epoch;
+
+    void link_child(Process&, uint32_t);
+    void unlink_child(Process&, uint32_t);
+    bool release_next();
+    bool has_dead_ancestor(uint32_t);
+    void advance_epoch();
+};
+
+#endif //PROCESS_TABLE_H
@@ -4,432 +4,1099 @@
 // Assignment: Process Scheduling     Date Assigned: 22 February 2016
 // Programmer: Evan Higgins           Date Completed: 18 March 2016
 
+#include <algorithm>
+#include <climits>
 #include "scheduler.hpp"
-#include <sstream>
 
 using namespace std;
 
 // ============================================================
-// Function: Scheduler(string, string)
+// Function: parse_affinity(string, Affinity&)
+// Returns:  bool
+//
+// Maps "local" or "spread" to its Affinity. Returns false for
+// anything else.
+// ============================================================
+bool parse_affinity(const string & name, Affinity & affinity) {
+    if(name == "local")
+        affinity = Affinity::Local;
+    else if(name == "spread")
+        affinity = Affinity::Spread;
+    else
+        return false;
+    return true;
+}
+
+// ============================================================
+// Function: BasicScheduler(int, StateSink&, unsigned)
 //
-// Constructs input files from passed strings and verifies that
-// they opened correctly. Incorrectly opened files are an
-// unrecoverable error and the scheduler will exit.
+// quantum is handed to the policy. Everything that happens
+// during the simulation is reported to sink, which must
+// outlive the scheduler. Every one of cpu_count CPUs starts
+// out idle.
 // ============================================================
-Scheduler::Scheduler(int quantum,
-                     string input_file_name,
-                     string output_file_name) :
-    input_file(input_file_name),
-    output_file(output_file_name),
-    idle_process(new IdleProcess())
+template<typename Policy>
+BasicScheduler<Policy>::BasicScheduler(int quantum, StateSink & sink, unsigned cpu_count) :
+    sink(sink),
+    processes(*this),
+    ready_queue(quantum, processes, cpu_count),
+    cpus(cpu_count),
+    idle_cpus(cpu_count),
+    loaded_cpus(cpu_count),
+    queued(0),
+    issuing(0),
+    affinity(Affinity::Local),
+    next_spread(0),
+    wait_queue(processes, QUEUE_LINKS),
+    begun(false),
+    ended(false),
+    commands(0),
+    ticks(0)
 {
-    if(!this->input_file.good()) {
-        cerr << "[ERROR]: Input file did not open correctly." << endl;
-        exit(1);
-    }
+    for(unsigned cpu = 0; cpu < cpu_count; ++cpu)
+        idle_cpus.push_back(cpu);
+}
 
-    if(!this->output_file.good()) {
-        cerr << "[ERROR]: Output file did not open correctly." << endl;
-        exit(1);
-    }
 
-    time_quantum = quantum;
-    current_process = idle_process;
+// ============================================================
+// Function: run(InputReader&)
+//
+// Runs the simulation on commands read from input.
+// ============================================================
+template<typename Policy>
+void BasicScheduler<Policy>::run(InputReader & input) {
+    run_lines(input, SIZE_MAX, UINT64_MAX);
+}
+
+// ============================================================
+// Function: run(InputReader&, size_t)
+//
+// Runs at most count more lines from input. A later run()
+// picks up where this one stopped.
+// ============================================================
+template<typename Policy>
+void BasicScheduler<Policy>::run(InputReader & input, size_t count) {
+    run_lines(input, count, UINT64_MAX);
 }
 
+// ============================================================
+// Function: run_until(InputReader&, uint64_t)
+//
+// Runs lines from input until at least tick ticks have run.
+// Lines are never split, so an "I n" line can carry the run
+// past tick.
+// ============================================================
+template<typename Policy>
+void BasicScheduler<Policy>::run_until(InputReader & input, uint64_t tick) {
+    run_lines(input, SIZE_MAX, tick);
+}
 
 // ============================================================
-// Function: run()
+// Function: run(const CommandBuffer&)
 //
-// run() is the input loop for a scheduler. It executes commands
-// from input_file line by line and updates the state of all
-// processes within it.
+// Runs the simulation on an already parsed input. commands is
+// only read, so other schedulers may run it at the same time.
 // ============================================================
-void Scheduler::run() {
-    print_state();
-    while(true) {
+template<typename Policy>
+void BasicScheduler<Policy>::run(const CommandBuffer & commands) {
+    CommandBuffer::Reader reader(commands);
+    run_lines(reader, SIZE_MAX, UINT64_MAX);
+}
 
-        string next_action;
-        getline(input_file, next_action);
-        this->output_file << next_action << endl;
+// ============================================================
+// Function: run(LineSource&)
+//
+// Runs the simulation on lines streamed in from elsewhere, such
+// as a Pipeline's parser stage or a daemon's producers.
+// ============================================================
+template<typename Policy>
+void BasicScheduler<Policy>::run(LineSource & input) {
+    run_lines(input, SIZE_MAX, UINT64_MAX);
+}
 
-        if(next_action == "X") {
-            this->output_file << "Current state of simulation:" << endl;
-            print_state();
+// ============================================================
+// Function: run_lines(Input&, size_t, uint64_t)
+//
+// run_lines() is the input loop for a scheduler. It executes
+// up to count commands from input line by line, stopping early
+// once until ticks have run, and updates the
+// state of all processes within it. Lines are parsed in place,
+// so a string is only built for a line that turns out to be
+// invalid. Binary traces are replayed without parsing at all.
+//
+// The run also ends if the input runs out before an X.
+// ============================================================
+template<typename Policy>
+template<typename Input>
+void BasicScheduler<Policy>::run_lines(Input & input, size_t count, uint64_t until) {
+    begin();
+
+    InputLine next_action;
+    for(; count > 0 && ticks < until && !ended; --count) {
+        if(!input.next(next_action)) {
+            ended = true;
             break;
         }
+        ++commands;
+
+        sink.command(next_action.text, next_action.length);
+        auto started = metrics.start();
 
-        current_process->tick();
-
-        parse_action(next_action);
-
-        if(current_process->is_idle()) {
-            current_process = get_next_process();
-            current_process->set_quantum(time_quantum);
-        } else if(current_process->is_exiting()) {
-            cascading_terminate(*current_process);
-            current_process = get_next_process();
-            current_process->set_quantum(time_quantum);
-        } else if(!current_process->quantum_remaining()) {
-            ready_enqueue(current_process);
-            current_process = get_next_process();
-            current_process->set_quantum(time_quantum);
+        if(next_action.length == 1 && next_action.text[0] == 'X') {
+            finish(started);
+            break;
         }
 
-        print_state();
-    }
+        //Commands from a binary trace, a CommandBuffer or a
+        //LineSource usually arrive already decoded.
+        bool valid = next_action.decoded ||
+                parse_command(next_action.text, next_action.length,
+                              next_action.command);
+        if(!valid)
+            error_unrecognized_action(
+                    string(next_action.text, next_action.length));
 
-    //Close to prevent remaining processes from printing 
-    //their terminate messages
-    output_file.close();
+        run_tick(valid ? &next_action.command : nullptr, started);
+    }
 }
 
 // ============================================================
-// Function: print_state()
+// Function: submit(const Command&)
+// Returns:  SubmitStatus
 //
-// Prints the state of the scheduler. It lists the running
-// process and its remaining quantum, all processes on the
-// ready queue and all processes on the wait queue.
+// Runs one command handed over directly, for programs that
+// embed the simulator instead of giving it an input file.
+// Nothing is parsed or formatted: the sink gets the command
+// itself through StateSink::submitted(). X ends the run as it
+// does in an input, and an idle command of n ticks runs them
+// all. An invalid command is rejected without using a tick.
 // ============================================================
-void Scheduler::print_state() {
-    output_file << *current_process
-                 << " running";
-    if(!current_process->is_idle()) {
-        output_file << " with "
-                     << current_process->get_remaining_quantum()
-                     << " left";
-    }
-    output_file << endl;
-
-    output_file << "Ready Queue: ";
-    for(auto& process : ready_queue) {
-        //Only valid references are printed.
-        auto ptr = process.lock();
-        if(ptr) {
-            output_file << *ptr << " ";
-        }
+template<typename Policy>
+SubmitStatus BasicScheduler<Policy>::submit(const Command & command) {
+    if(ended)
+        return SubmitStatus::Finished;
+    if(command.type > CommandType::Exit ||
+            (command.type == CommandType::Idle && command.args[0] < 1) ||
+            (command.type == CommandType::Create &&
+             (command.args[3] < 0 || command.args[3] > CREATE_BULK_MAX ||
+              static_cast<long long>(command.args[0]) + command.args[3] - 1 > INT_MAX)) ||
+            (command.type == CommandType::Wait && command.args[1] < 0) ||
+            (command.type == CommandType::Event &&
+             command.extra_events >= COMMAND_EVENTS_MAX))
+        return SubmitStatus::Invalid;
+
+    begin();
+    ++commands;
+    sink.submitted(command);
+    auto started = metrics.start();
+
+    if(command.type == CommandType::Exit) {
+        finish(started);
+        return SubmitStatus::Ok;
     }
+    return run_tick(&command, started) ? SubmitStatus::Ok : SubmitStatus::Ignored;
+}
 
-    output_file << endl << "Wait Queue: ";
-    for(auto& process : wait_queue) {
-        //Only valid references are printed.
-        auto ptr = process.lock();
-        if(ptr) {
-            output_file << *ptr << " " << ptr->get_waiting_on();
-        }
+// ============================================================
+// Function: begin()
+//
+// Reports the initial state, unless this run already has.
+// ============================================================
+template<typename Policy>
+void BasicScheduler<Policy>::begin() {
+    if(!begun) {
+        sink.state(*this);
+        begun = true;
     }
+}
 
-    output_file << endl;
+// ============================================================
+// Function: finish(Metrics::Time)
+//
+// Ends the run at X: every terminated process is released and
+// the final state reported.
+// ============================================================
+template<typename Policy>
+void BasicScheduler<Policy>::finish(Metrics::Time started) {
+    processes.reclaim_all();
+    metrics.command(true, CommandType::Exit, started);
+    sink.finish(*this);
+    ended = true;
 }
 
 // ============================================================
-// Function: parse_action
-// Return:   bool
+// Function: run_tick(const Command*, Metrics::Time)
+// Returns:  bool
 //
-// Parses input and calls necessary functions. Scheduling logic
-// is not contained here. It is entirely input validation. And
-// control flow delegation.
+// Runs the tick of a command that has already been reported to
+// the sink, or of an invalid line if command is null, and then
+// reports the state. Returns whether the command had any
+// effect.
 // ============================================================
-void Scheduler::parse_action(const string & action) {
-    vector<string> tokens = split_on_space(action);
-    if(tokens.empty()) {
-        error_unrecognized_action(action);
-        return;
-    }
-    if(tokens[0] == "C") {
-        //Create action takes the form: "C # #"
-        if(tokens.size() != 3) {
-            error_unrecognized_action(action);
-            return;
-        }
+template<typename Policy>
+bool BasicScheduler<Policy>::run_tick(const Command * command, Metrics::Time started) {
+    //Commands are issued on each CPU in turn.
+    issuing = ticks % cpus.size();
+    ++ticks;
+    sync(issuing);
 
-        //Both arguments to "C" must be integers
-        if(!is_number_str(tokens[1]) || !is_number_str(tokens[2])) {
-            error_unrecognized_action(action);
-            return;
-        }
+    bool effective = command && execute(*command);
 
-        create_process(stoi(tokens[1]), stoi(tokens[2]));
+    end_tick();
 
-    } else if(tokens[0] == "D") {
-        //Destroy action takes the form: "D #"
-        if(tokens.size() != 2) {
-            error_unrecognized_action(action);
-            return;
-        }
+    //An "I n" line is n ticks, of which this was the first.
+    if(command && command->type == CommandType::Idle)
+        idle(command->args[0] - 1);
 
-        //Argument to D must be integer
-        if(!is_number_str(tokens[1])) {
-            error_unrecognized_action(action);
-            return;
-        }
+    metrics.queue_lengths(queued, wait_queue.size());
+    metrics.command(command != nullptr,
+                    command ? command->type : CommandType::Exit,
+                    started);
 
-        destroy_by_pid(stoi(tokens[1]));
+    sink.state(*this);
+    return effective;
+}
 
-    } else if(tokens[0] == "I") {
-        //Execute no action on idle
+// ============================================================
+// Function: end_tick()
+//
+// Finishes a tick once its command has run: releases what the
+// reclaim budget allows, wakes the waits timing out, then
+// looks at the issuing CPU and
+// every CPU whose process has run out of burst or quantum.
+// Idle CPUs then take whatever is still queued.
+// ============================================================
+template<typename Policy>
+void BasicScheduler<Policy>::end_tick() {
+    processes.reclaim();
 
-    } else if(tokens[0] == "W") {
-        //Wait action takes the form: "W #"
-        if(tokens.size() != 2) {
-            error_unrecognized_action(action);
-            return;
-        }
+    uint32_t slot;
+    while(timers.expire(ticks, slot))
+        time_out(slot);
 
-        //Argument to W must be an integer
-        if(!is_number_str(tokens[1])) {
-            error_unrecognized_action(action);
-            return;
-        }
+    attend(issuing);
+    while(!expiries.empty() && expiries.top().first <= ticks) {
+        Expiry expiry = expiries.top();
+        expiries.pop();
+        if(cpus[expiry.second].expires_at == expiry.first)
+            attend(expiry.second);
+    }
 
-        wait_for_event(stoi(tokens[1]));
+    //A CPU that finds nothing live has emptied every queue on
+    //the way, so the loop ends there.
+    while(queued > 0 && !idle_cpus.empty()) {
+        unsigned cpu = idle_cpus.front();
+        dispatch(cpu);
+        if(idle_cpus.contains(cpu))
+            break;
+    }
+}
 
-    } else if(tokens[0] == "E") {
-        //Event action takes the form: "E #"
-        if(tokens.size() != 2) {
-            error_unrecognized_action(action);
-            return;
-        }
+// ============================================================
+// Function: attend(unsigned)
+//
+// Replaces the process running on cpu if it is idle, exiting
+// or out of quantum.
+// ============================================================
+template<typename Policy>
+void BasicScheduler<Policy>::attend(unsigned cpu) {
+    sync(cpu);
+    Process & process = *processes.get(cpus[cpu].current);
+
+    if(process.is_idle()) {
+        dispatch(cpu);
+    } else if(process.is_exiting()) {
+        cascading_terminate(cpus[cpu].current);
+        dispatch(cpu);
+    } else if(!process.quantum_remaining()) {
+        preempt_expired(cpu);
+        dispatch(cpu);
+    }
+}
 
-        //Argument to E must be an integer
-        if(!is_number_str(tokens[1])) {
-            error_unrecognized_action(action);
-            return;
+// ============================================================
+// Function: idle(int)
+//
+// Runs ticks ticks with no commands. The result, including
+// every queue transition reported to the sink, is the same as
+// that many I lines, less the state after each of them.
+//
+// Rather than stepping every tick it jumps straight to the
+// next tick that can change anything: the tick the first
+// running process uses up its burst or quantum, or the next
+// wait times out. Once nothing is running and no wait can time
+// out nothing can change at all. Only ticks with
+// terminated processes still waiting to be reclaimed are
+// stepped one at a time, since each of them releases some.
+// ============================================================
+template<typename Policy>
+void BasicScheduler<Policy>::idle(int ticks_left) {
+    while(ticks_left > 0) {
+        if(!processes.reclaim_pending()) {
+            while(!expiries.empty() &&
+                    cpus[expiries.top().second].expires_at != expiries.top().first)
+                expiries.pop();
+            uint64_t next = timers.next_due();
+            if(!expiries.empty())
+                next = min(next, expiries.top().first);
+            if(next == UINT64_MAX) {
+                ticks += ticks_left;
+                return;
+            }
+
+            //Ticks before the one that ends a burst or quantum or
+            //might time a wait out.
+            uint64_t quiet = next > ticks ? next - ticks - 1 : 0;
+            if(quiet > 0) {
+                quiet = min(quiet, static_cast<uint64_t>(ticks_left));
+                ticks += quiet;
+                ticks_left -= quiet;
+                continue;
+            }
         }
 
-        signal_event(stoi(tokens[1]));
+        issuing = ticks % cpus.size();
+        ++ticks;
+        --ticks_left;
+        end_tick();
+    }
+}
 
-    } else if(tokens[0] == "X") {
-        return;
+// ============================================================
+// Function: set_reclaim_budget(size_t)
+//
+// Limits how many terminated processes are released per tick.
+// The default of 0 releases a terminated subtree (and prints
+// its termination messages) on the tick it is terminated.
+// ============================================================
+template<typename Policy>
+void BasicScheduler<Policy>::set_reclaim_budget(size_t budget) {
+    processes.set_reclaim_budget(budget);
+}
 
-    } else {
-        error_unrecognized_action(action);
-        return;
+// ============================================================
+// Function: running()
+// Returns:  Process&
+//
+// The process running on the issuing CPU. A CPU's current
+// handle is never stale: it is reset to IDLE_HANDLE whenever
+// its process terminates.
+// ============================================================
+template<typename Policy>
+Process & BasicScheduler<Policy>::running() {
+    return *processes.get(cpus[issuing].current);
+}
+
+// ============================================================
+// Function: running_process(unsigned)
+// Returns:  const Process&
+//
+// The process running on cpu, brought up to date first. That
+// only applies ticks that have already run, so it doesn't
+// change the simulation and is allowed here.
+// ============================================================
+template<typename Policy>
+const Process & BasicScheduler<Policy>::running_process(unsigned cpu) const {
+    const_cast<BasicScheduler*>(this)->sync(cpu);
+    return *processes.get(cpus[cpu].current);
+}
 
+// ============================================================
+// Function: sync(unsigned)
+//
+// Applies the ticks cpu's process has run since it was last
+// brought up to date.
+// ============================================================
+template<typename Policy>
+void BasicScheduler<Policy>::sync(unsigned index) {
+    Cpu & cpu = cpus[index];
+    if(cpu.current != IDLE_HANDLE && cpu.synced_at != ticks) {
+        processes.at(cpu.current.index).advance(static_cast<int>(ticks - cpu.synced_at));
+        cpu.synced_at = ticks;
     }
 }
 
 // ============================================================
-// Function: get_next_process
-// Returns:  shared_ptr<Process>
+// Function: execute(const Command&)
+// Returns:  bool
 //
-// Since ready_queue consists of weak_ptr<Process> getting the
-// next process from the queue is not as simple as getting the
-// queue's head. Instead it requires removing weak_ptrs from
-// the head of the list until a valid pointer is found. If none
-// are found the running process should be idle.
+// Calls the function for an already validated command.
+// Scheduling logic is not contained here. It is entirely
+// control flow delegation. Returns false if the command had no
+// effect.
 // ============================================================
-shared_ptr<Process> Scheduler::get_next_process() {
-    for(auto iter = ready_queue.begin(); iter != ready_queue.end();) {
-        auto shared_p = iter->lock();
-        if(shared_p) {
-            ready_queue.erase(iter);
-            return shared_p;
-        } else {
-            iter = ready_queue.erase(iter);
+template<typename Policy>
+bool BasicScheduler<Policy>::execute(const Command & command) {
+    switch(command.type) {
+    case CommandType::Create:
+        if(command.args[3] != 0)
+            return create_processes(command.args[0], command.args[3],
+                                    command.args[1], command.args[2]);
+        return create_process(command.args[0], command.args[1], command.args[2]);
+    case CommandType::Destroy:
+        return destroy_by_pid(command.args[0]);
+    case CommandType::Wait:
+        return wait_for_event(command.args[0], command.args[1]);
+    case CommandType::Event:
+        return signal_event(command);
+    case CommandType::Idle:
+    case CommandType::Exit:
+        //Execute no action on idle
+        break;
+    }
+    return true;
+}
+
+// ============================================================
+// Function: dispatch(unsigned)
+//
+// Runs the next process for cpu, which must be idle, and
+// files the tick it will run out of burst or quantum. Leaves
+// the CPU idle if there is nothing to run.
+// ============================================================
+template<typename Policy>
+void BasicScheduler<Policy>::dispatch(unsigned index) {
+    Cpu & cpu = cpus[index];
+    cpu.current = get_next_process(index);
+    if(cpu.current == IDLE_HANDLE) {
+        cpu.expires_at = UINT64_MAX;
+        idle_cpus.push_back(index);
+        return;
+    }
+
+    const Process & process = processes.at(cpu.current.index);
+    int left = min(process.get_remaining_burst(), process.get_remaining_quantum());
+    cpu.synced_at = ticks;
+    cpu.expires_at = ticks + max(left, 1);
+    expiries.push(Expiry(cpu.expires_at, index));
+    idle_cpus.remove(index);
+}
+
+// ============================================================
+// Function: get_next_process(unsigned)
+// Returns:  ProcessHandle
+//
+// Takes processes off the head of cpu's ready queue until a
+// live one is found. Once that queue is empty it steals from
+// the heads of other CPUs' queues instead, moving each CPU it
+// steals from to the back of loaded_cpus. Only a terminated
+// process still waiting to be reclaimed can be passed over. If
+// none are found the CPU should be idle. The process found is
+// given the quantum its policy allows.
+// ============================================================
+template<typename Policy>
+ProcessHandle BasicScheduler<Policy>::get_next_process(unsigned cpu) {
+    ProcessHandle next;
+    unsigned from = cpu;
+    while(true) {
+        if(!pop_ready(from, next)) {
+            if(queued == 0)
+                return IDLE_HANDLE;
+            from = loaded_cpus.front();
+            continue;
+        }
+
+        auto process = processes.get(next);
+        if(process) {
+            if(from != cpu) {
+                metrics.stolen();
+                loaded_cpus.remove(from);
+                if(ready_queue.size(from) > 0)
+                    loaded_cpus.push_back(from);
+            }
+            process->set_cpu(cpu);
+            process->set_quantum(ready_queue.quantum(*process));
+            metrics.dispatched();
+            sink.dispatched(*process);
+            return next;
         }
+        metrics.stale_skipped();
     }
-    return idle_process;
 }
 
 // ============================================================
-// Function: create_process(int, int)
+// Function: pop_ready(unsigned, ProcessHandle&)
+// Returns:  bool
+//
+// Takes the head of cpu's ready queue, live or not. Returns
+// false if the queue is empty.
+// ============================================================
+template<typename Policy>
+bool BasicScheduler<Policy>::pop_ready(unsigned cpu, ProcessHandle & handle) {
+    if(!ready_queue.pop(cpu, handle))
+        return false;
+    --queued;
+    if(ready_queue.size(cpu) == 0)
+        loaded_cpus.remove(cpu);
+    processes.at(handle.index).set_ready(false);
+    return true;
+}
+
+// ============================================================
+// Function: stop(unsigned)
+//
+// Takes the running process off cpu, up to date, without
+// queueing it anywhere, leaving the CPU idle.
+// ============================================================
+template<typename Policy>
+void BasicScheduler<Policy>::stop(unsigned index) {
+    sync(index);
+    Cpu & cpu = cpus[index];
+    cpu.current = IDLE_HANDLE;
+    cpu.expires_at = UINT64_MAX;
+    idle_cpus.push_back(index);
+}
+
+// ============================================================
+// Function: stop_killed()
+//
+// Stops every CPU running a process that is no longer live.
+// ============================================================
+template<typename Policy>
+void BasicScheduler<Policy>::stop_killed() {
+    for(unsigned cpu = 0; cpu < cpus.size(); ++cpu)
+        if(cpus[cpu].current != IDLE_HANDLE && !processes.get(cpus[cpu].current))
+            stop(cpu);
+}
+
+// ============================================================
+// Function: preempt_expired(unsigned)
+//
+// Puts the process running on cpu, which has used up its
+// quantum, back on cpu's ready queue and leaves the CPU idle.
+// ============================================================
+template<typename Policy>
+void BasicScheduler<Policy>::preempt_expired(unsigned cpu) {
+    metrics.quantum_expired();
+    ProcessHandle handle = cpus[cpu].current;
+    stop(cpu);
+    ready_queue.expired(processes.at(handle.index));
+    ready_enqueue(handle, cpu);
+}
+
+// ============================================================
+// Function: create_process(int, int, int)
+// Returns:  bool
 //
 // New processes are implicitly children of the running process.
-// Here a new process is initialized and added to the
-// ready_queue. Processes are passed a closure which outputs
-// a terminate message for their on_delete parameter.
+// Here a new process is initialized and added to the ready
+// queue of the CPU its affinity picks.
+//
+// PIDs are assumed to be unique among live processes. If a
+// PID is reused while the original is still alive only the
+// original is reachable through destroy_by_pid. Returns false,
+// creating nothing, if the running process is exiting.
 // ============================================================
-void Scheduler::create_process(int PID, int burst) {
+template<typename Policy>
+bool BasicScheduler<Policy>::create_process(int PID, int burst, int priority) {
     //An exiting process's children will die when it terminates so
     //there is no point in creating a new child.
-    if(current_process->is_exiting())
-        return;
+    if(running().is_exiting())
+        return false;
+
+    ProcessHandle child = processes.create(PID, burst, cpus[issuing].current);
+
+    processes.get(child)->set_priority(priority);
+    sink.created(*processes.get(child));
 
-    shared_ptr<Process> child(
-            new Process(PID, burst, current_process,
-                [this](Process & p) {
-                    if(output_file.is_open())
-                        output_file << p << " terminated" << endl;
-                }));
-    current_process->add_child(child);
-    if(!current_process->quantum_remaining()) {
-        ready_enqueue(current_process);
-        current_process = idle_process;
+    //A terminated process waiting to be reclaimed may still hold
+    //the entry for this PID.
+    auto entry = process_index.find(PID);
+    if(entry == process_index.end() || !processes.get(entry->second))
+        process_index[PID] = child;
+
+    unsigned cpu = issuing;
+    if(affinity == Affinity::Spread) {
+        cpu = next_spread;
+        next_spread = (next_spread + 1) % cpus.size();
     }
-    ready_enqueue(weak_ptr<Process>(child));
+
+    if(!running().quantum_remaining())
+        preempt_expired(issuing);
+    ready_enqueue(child, cpu);
+    return true;
 }
 
 // ============================================================
-// Function: wait_for_event(int)
+// Function: create_processes(int, int, int, int)
+// Returns:  bool
+//
+// A C*: count children with consecutive PIDs from first_PID,
+// one per tick, starting on the tick already under way. Every
+// tick but the last is finished here and the caller finishes
+// the last, so the result, including every queue transition
+// reported to the sink, is the same as the count C lines it
+// stands for, less the state after each of them. Each child is
+// the child of whatever is running when its tick comes, as it
+// would be for those lines.
+//
+// The table and PID index are grown once for the whole batch
+// up front, which CREATE_BULK_MAX keeps to a bounded size.
+// Returns false if no child could be created.
+// ============================================================
+template<typename Policy>
+bool BasicScheduler<Policy>::create_processes(int first_PID, int count, int burst, int priority) {
+    processes.reserve(count);
+    size_t indexed = process_index.size() + count;
+    if(indexed > process_index.bucket_count() * process_index.max_load_factor())
+        process_index.reserve(max(indexed, 2 * process_index.size()));
+
+    bool created = false;
+    for(int i = 0; i < count; ++i) {
+        if(i > 0) {
+            end_tick();
+            issuing = ticks % cpus.size();
+            ++ticks;
+            sync(issuing);
+        }
+        created = create_process(first_PID + i, burst, priority) || created;
+    }
+    return created;
+}
+
+// ============================================================
+// Function: wait_for_event(int, int)
+// Returns:  bool
 //
 // Moves the currently running process to the wait queue and
-// sets it to wait on event_id.
+// sets it to wait on event_id. With a timeout it is woken
+// timeout ticks from now if the event hasn't come by then.
+// Returns false if nothing is running or the running process
+// is exiting.
 // ============================================================
-void Scheduler::wait_for_event(int event_id) {
-    if(current_process->is_idle())
-        return;
+template<typename Policy>
+bool BasicScheduler<Policy>::wait_for_event(int event_id, int timeout) {
+    if(running().is_idle())
+        return false;
 
     //An exiting process should not be placed on the wait queue.
-    if(current_process->is_exiting())
-        return;
+    if(running().is_exiting())
+        return false;
 
-    current_process->wait_on(event_id);
-
-    wait_enqueue(weak_ptr<Process>(current_process));
+    ready_queue.blocked(running());
+    running().wait_on(event_id);
 
     //Set to idle until next process switch occurs
-    current_process = idle_process;
+    ProcessHandle handle = cpus[issuing].current;
+    stop(issuing);
+
+    wait_enqueue(handle);
+    if(timeout > 0)
+        timers.arm(handle.index, ticks + timeout);
+    return true;
 }
 
 // ============================================================
-// Function: signal_event(int)
+// Function: signal_event(const Command&)
+// Returns:  bool
 //
-// Finds all processes on the event queue which are waiting
-// on event_id and are valid references. The whole wait_queue
-// must be searched because multiple processes can respond to
-// the same event. In this case the processes will be added to
-// the ready_queue in the order in which they were placed on
-// the wait_queue.
+// Signals each event an E names, in the order given, within
+// the one tick. Returns false if nobody was woken.
 // ============================================================
-void Scheduler::signal_event(int event_id) {
-    if(!current_process->quantum_remaining()) {
-        ready_enqueue(current_process);
-        current_process = idle_process;
-    }
-    for(auto i = wait_queue.begin(); i != wait_queue.end();) {
-        auto shared_proc = i->lock();
-        if(shared_proc) {
-            if(shared_proc->receive_event(event_id)) {
-                wait_queue.erase(i);
-                ready_enqueue(weak_ptr<Process>(shared_proc));
-                return;
-            } else {
-                ++i;
-            }
+template<typename Policy>
+bool BasicScheduler<Policy>::signal_event(const Command & command) {
+    if(!running().quantum_remaining())
+        preempt_expired(issuing);
+
+    bool woken = false;
+    for(int i = 0; i <= command.extra_events; ++i)
+        woken = wake_waiters(command.args[i], command.broadcast) || woken;
+    return woken;
+}
+
+// ============================================================
+// Function: wake_waiters(int, bool)
+// Returns:  bool
+//
+// Wakes the longest waiting live process which is waiting on
+// event_id, or every one of them in the order they started
+// waiting if all is set. Waiters for each event are linked in
+// their own FIFO so only that event's waiters are looked at,
+// and waking k of them takes O(k). Terminated processes still
+// waiting to be reclaimed are taken off both queues along the
+// way. A process woken goes back on the ready queue of the CPU
+// it last ran on. Returns false if no live process was waiting.
+// ============================================================
+template<typename Policy>
+bool BasicScheduler<Policy>::wake_waiters(int event_id, bool all) {
+    bool woken = false;
+    auto entry = event_waiters.find(event_id);
+    while(entry != event_waiters.end()) {
+        Process & waiter = entry->second.front();
+        ProcessHandle handle = waiter.get_handle();
+        bool last = entry->second.size() == 1;
+
+        //Erases entry once its last waiter is gone.
+        wait_unlink(waiter);
+        waiter.receive_event(event_id);
+
+        if(processes.get(handle)) {
+            sink.woken(waiter);
+            ready_enqueue(handle, waiter.get_cpu());
+            woken = true;
+            if(!all)
+                break;
         } else {
-            i = wait_queue.erase(i);
+            metrics.stale_skipped();
         }
+        if(last)
+            break;
+    }
+    return woken;
+}
+
+// ============================================================
+// Function: time_out(uint32_t)
+//
+// Wakes the process in slot, whose wait has timed out, the
+// same way an event would have. A terminated process still
+// waiting to be reclaimed is only taken off the wait queue.
+// ============================================================
+template<typename Policy>
+void BasicScheduler<Policy>::time_out(uint32_t slot) {
+    Process & waiter = processes.at(slot);
+    ProcessHandle handle = waiter.get_handle();
+
+    wait_unlink(waiter);
+    waiter.receive_event(waiter.get_waiting_on());
+
+    if(processes.get(handle)) {
+        metrics.timed_out();
+        sink.woken(waiter);
+        ready_enqueue(handle, waiter.get_cpu());
+    } else {
+        metrics.stale_skipped();
     }
 }
 
 // ============================================================
 // Function: destroy_by_pid(int)
+// Returns:  bool
 //
-// Recursively searches the Process graph for a matching PID
-// and terminates that process. Ignores processes not owned
-// by the currently running process.
+// Looks up the process with a matching PID in process_index
+// and terminates it. Ignores processes not owned by the
+// process issuing the command. Returns false if nothing was
+// terminated.
 // ============================================================
-void Scheduler::destroy_by_pid(int pid) {
-    if(current_process->is_exiting())
-        return;
+template<typename Policy>
+bool BasicScheduler<Policy>::destroy_by_pid(int pid) {
+    if(running().is_exiting())
+        return false;
 
-    if(!current_process->owns(pid))
-        return;
+    auto entry = process_index.find(pid);
+    if(entry == process_index.end())
+        return false;
 
-    idle_process->search_children_until([pid, this](Process & p) {
-                if(p.get_PID() == pid) {
-                    cascading_terminate(p);
-                    return true;
-                }
-                return false;
-            });
+    if(!processes.owns(cpus[issuing].current, entry->second))
+        return false;
+
+    cascading_terminate(entry->second);
+    return true;
 }
 
 // ============================================================
-// Function: cascading_terminate(Process&)
+// Function: cascading_terminate(ProcessHandle)
 //
-// Processes are represented as a tree of references.
-// A parent process P has a vector of shared_ptrs to its children
-// and each child process has a weak_ptr reference to its parents.
+// Processes are represented as a tree of handles. A parent
+// process P holds the handles of its children and each child
+// holds the handle of its parent. Terminating P releases its
+// slot in the process table and the slots of its whole subtree,
+// which turns every other handle to them into a stale one.
 //
-// All references other than these must be weak_ptrs (or temporary
-// shared_ptr accesses of these weak_ptrs). This rule ensures
-// that once a parent's shared_ptr reference to a child process
-// is destructed it will free that process, which will cascade
-// down the tree terminating each process.
+// Processes of the subtree running on other CPUs are stopped
+// as they are released. With a reclaim budget they aren't
+// released yet, so the CPUs are checked for them right away
+// instead.
 // ============================================================
-void Scheduler::cascading_terminate(Process & process) {
+template<typename Policy>
+void BasicScheduler<Policy>::cascading_terminate(ProcessHandle process) {
     //The idle process should not be deleted. It also
     //should never have a request to delete it, but this
     //ensures that it won't be.
-    if(process.is_idle())
+    if(process == IDLE_HANDLE)
+        return;
+
+    auto target = processes.get(process);
+    if(!target)
         return;
 
-    //If the current process is being deleted the shared_ptr
-    //held by current_process must be deleted otherwise the
-    //shared_ptr semantics of process destruction is ignored.
-    if(*current_process == process) {
-        current_process = idle_process;
+    //A CPU must not be left running a terminated process.
+    if(cpus[target->get_cpu()].current == process)
+        stop(target->get_cpu());
+
+    sink.killed(*target);
+    processes.terminate(process);
+
+    if(processes.reclaim_pending() && cpus.size() > 1)
+        stop_killed();
+}
+
+// ============================================================
+// Function: terminated(const Process&)
+//
+// Called by the process table for every process it releases.
+// Outputs the terminate message and drops the process from
+// process_index and whichever queue or CPU it is on.
+// ============================================================
+template<typename Policy>
+void BasicScheduler<Policy>::terminated(Process & process) {
+    unsigned cpu = process.get_cpu();
+    if(cpus[cpu].current == process.get_handle())
+        stop(cpu);
+
+    sink.terminated(process);
+
+    if(process.is_ready()) {
+        ready_queue.remove(process, cpu);
+        --queued;
+        if(ready_queue.size(cpu) == 0)
+            loaded_cpus.remove(cpu);
+    } else if(process.is_waiting()) {
+        wait_unlink(process);
     }
 
-    //show_terminate_message(process);
-    process.terminate();
+    //process no longer resolves through the table, so only a
+    //live process reusing the PID keeps the entry.
+    auto entry = process_index.find(process.get_PID());
+    if(entry != process_index.end() && !processes.get(entry->second))
+        process_index.erase(entry);
 }
 
 // ============================================================
-// Function: ready_enqueue(weak_ptr<Process>)
+// Function: ready_enqueue(ProcessHandle, unsigned)
 //
-// Enqueues a process to ready_queue if it is a valid weak_ptr.
+// Enqueues a process to cpu's ready queue if it is a valid
+// handle.
 // ============================================================
-void Scheduler::ready_enqueue(const weak_ptr<Process> & proc) {
-    auto shared_proc = proc.lock();
-    if(shared_proc) {
-        output_file << *shared_proc << " placed on Ready Queue" << endl;
-        ready_queue.push_back(proc);
+template<typename Policy>
+void BasicScheduler<Policy>::ready_enqueue(ProcessHandle handle, unsigned cpu) {
+    auto process = processes.get(handle);
+    if(process) {
+        metrics.ready_enqueued();
+        sink.ready_enqueued(*process);
+        process->set_ready(true);
+        process->set_cpu(cpu);
+        ready_queue.push(*process, cpu);
+        ++queued;
+        loaded_cpus.push_back(cpu);
     }
 }
 
 // ============================================================
-// Function: wait_enqueue(weak_ptr<Process>)
+// Function: wait_enqueue(ProcessHandle)
 //
-// Enqueues a process to wait_queue if it is a valid weak_ptr.
+// Enqueues a process to wait_queue if it is a valid handle
+// and files it under the event it is waiting on.
 // ============================================================
-void Scheduler::wait_enqueue(const weak_ptr<Process> & proc) {
-    auto shared_proc = proc.lock();
-    if(shared_proc) {
-        output_file << *shared_proc << " placed on Wait Queue" << endl;
-        wait_queue.push_back(proc);
+template<typename Policy>
+void BasicScheduler<Policy>::wait_enqueue(ProcessHandle handle) {
+    auto process = processes.get(handle);
+    if(process) {
+        metrics.wait_enqueued();
+        sink.wait_enqueued(*process);
+        wait_queue.push_back(*process);
+
+        int event_id = process->get_waiting_on();
+        auto entry = event_waiters.find(event_id);
+        if(entry == event_waiters.end())
+            entry = event_waiters.emplace(event_id,
+                        ProcessList(processes, EVENT_LINKS)).first;
+        entry->second.push_back(*process);
     }
 }
 
-void Scheduler::error_unrecognized_action(const string & action) {
-    cerr << "[ERROR]: Unrecognized command: " << action << endl;
+// ============================================================
+// Function: wait_unlink(Process&)
+//
+// Takes a waiting process off wait_queue and off the waiters
+// of its event, dropping the event once nobody waits on it,
+// and disarms its timeout.
+// ============================================================
+template<typename Policy>
+void BasicScheduler<Policy>::wait_unlink(Process & process) {
+    wait_queue.unlink(process);
+    timers.cancel(process.get_handle().index);
+
+    auto entry = event_waiters.find(process.get_waiting_on());
+    entry->second.unlink(process);
+    if(entry->second.empty())
+        event_waiters.erase(entry);
+}
+
+template<typename Policy>
+void BasicScheduler<Policy>::error_unrecognized_action(const string & action) {
+    //Written in one piece so concurrent runs don't interleave
+    //their messages mid line.
+    cerr << ("[ERROR]: Unrecognized command: " + action + "\n");
 }
 
 // ============================================================
-// Function: split_on_space
-// Returns:  vector<string>
+// Function: save(SnapshotWriter&)
 //
-// For reasons which I do not understand there is not a split
-// function in the C++ standard library. This function is needed
-// to tokenize the input actions for parsing.
+// Writes the complete state of the simulation: how far it got,
+// the process table, process_index, the CPUs and every queue.
+// Metrics are not part of a snapshot, and neither are the
+// number of CPUs and the affinity, which the scheduler is
+// created with.
 // ============================================================
-vector<string> split_on_space(const string & str) {
-    vector<string> tokens;
-    istringstream strstream(str);
+template<typename Policy>
+void BasicScheduler<Policy>::save(SnapshotWriter & out) const {
+    out.put(commands);
+    out.put(ticks);
+    out.put(ended);
 
-    while(strstream.good()) {
-        string next_token;
-        strstream >> next_token;
-        if(!next_token.empty())
-            tokens.push_back(next_token);
+    processes.save(out);
+
+    for(auto & cpu : cpus) {
+        save_handle(out, cpu.current);
+        out.put(cpu.synced_at);
+        out.put(cpu.expires_at);
+    }
+    idle_cpus.save(out);
+    loaded_cpus.save(out);
+    out.put(next_spread);
+
+    out.put(process_index.size());
+    for(auto & entry : process_index) {
+        out.put_signed(entry.first);
+        save_handle(out, entry.second);
+    }
+
+    ready_queue.save(out);
+    wait_queue.save(out);
+
+    out.put(event_waiters.size());
+    for(auto & entry : event_waiters) {
+        out.put_signed(entry.first);
+        entry.second.save(out);
     }
 
-    return tokens;
+    timers.save(out);
 }
 
 // ============================================================
-// Function: is_number_st
+// Function: restore(SnapshotReader&)
 // Returns:  bool
 //
-// Returns true if the string represents an integer.
-// i.e. All of its chars are digits.
+// Replaces the state of a scheduler that hasn't run yet with
+// one read back from a snapshot. Running it then continues
+// with the line after the last one the snapshot had run, with
+// the same output an uninterrupted run would have had from
+// there. Returns false if the snapshot is malformed.
 // ============================================================
-bool is_number_str(const string & str) {
-    for(auto &c : str) {
-        if(!isdigit(c))
-            return false;
+template<typename Policy>
+bool BasicScheduler<Policy>::restore(SnapshotReader & in) {
+    commands = in.get();
+    ticks = in.get();
+    ended = in.get() != 0;
+
+    bool valid = processes.restore(in);
+    for(uint32_t index = 0; valid && index < processes.slot_count(); ++index)
+        valid = processes.at(index).get_cpu() < cpus.size();
+
+    expiries = decltype(expiries)();
+    for(unsigned index = 0; index < cpus.size(); ++index) {
+        Cpu & cpu = cpus[index];
+        cpu.current = restore_handle(in);
+        cpu.synced_at = in.get();
+        cpu.expires_at = in.get();
+        if(cpu.current != IDLE_HANDLE)
+            expiries.push(Expiry(cpu.expires_at, index));
     }
-    return true;
+    valid = idle_cpus.restore(in) && valid;
+    valid = loaded_cpus.restore(in) && valid;
+    next_spread = static_cast<unsigned>(in.get());
+    valid = valid && next_spread < cpus.size();
+
+    process_index.clear();
+    size_t count = in.get_count();
+    for(size_t i = 0; i < count && in.good(); ++i) {
+        int pid = in.get_int();
+        ProcessHandle handle = restore_handle(in);
+        valid = valid && handle.index < processes.slot_count();
+        process_index[pid] = handle;
+    }
+
+    valid = ready_queue.restore(in) && valid;
+    valid = wait_queue.restore(in) && valid;
+
+    event_waiters.clear();
+    count = in.get_count();
+    for(size_t i = 0; i < count && in.good(); ++i) {
+        int event_id = in.get_int();
+        ProcessList waiters(processes, EVENT_LINKS);
+        valid = waiters.restore(in) && valid;
+        event_waiters.emplace(event_id, waiters);
+    }
+
+    //Only a process on the wait queue can have a timeout.
+    valid = timers.restore(in, processes.slot_count()) && valid;
+    for(uint32_t index = 0; valid && index < processes.slot_count(); ++index)
+        valid = !timers.armed(index) || processes.at(index).is_waiting();
+
+    //The idle and loaded CPUs have to agree with the CPUs and
+    //queues, and every running process has to be live.
+    queued = 0;
+    for(unsigned index = 0; valid && index < cpus.size(); ++index) {
+        const Cpu & cpu = cpus[index];
+        size_t length = ready_queue.size(index);
+        queued += length;
+        valid = processes.get(cpu.current) != nullptr &&
+                idle_cpus.contains(index) == (cpu.current == IDLE_HANDLE) &&
+                loaded_cpus.contains(index) == (length > 0);
+    }
+
+    begun = true;
+    return valid && in.good();
+}
+
+template<typename Policy>
+void BasicScheduler<Policy>::visit_ready(unsigned cpu, ProcessVisitor & visitor) const {
+    ready_queue.for_each(cpu, [&](ProcessHandle handle) {
+                auto process = processes.get(handle);
+                if(process)
+                    visitor.visit(*process);
+            });
+}
+
+template<typename Policy>
+void BasicScheduler<Policy>::visit_waiting(ProcessVisitor & visitor) const {
+    wait_queue.for_each([&](const Process & process) {
+                if(processes.get(process.get_handle()))
+                    visitor.visit(process);
+            });
+}
+
+template class BasicScheduler<RoundRobinPolicy>;
+template class BasicScheduler<FeedbackPolicy>;
+template class BasicScheduler<PriorityPolicy>;
+template class BasicScheduler<ShortestBurstPolicy>;
+template class BasicScheduler<FairSharePolicy>;
+
+// ============================================================
+// Function: make_scheduler(SchedulingPolicy, int, unsigned,
+//                          StateSink&)
+// Returns:  unique_ptr<Scheduler>
+//
+// Creates a scheduler running policy with the given quantum on
+// cpus CPUs. The policy is picked here once; from then on the
+// scheduler calls into it directly.
+// ============================================================
+unique_ptr<Scheduler> make_scheduler(SchedulingPolicy policy,
+                                     int quantum,
+                                     unsigned cpus,
+                                     StateSink & sink) {
+    switch(policy) {
+    case SchedulingPolicy::Feedback:
+        return unique_ptr<Scheduler>(new BasicScheduler<FeedbackPolicy>(quantum, sink, cpus));
+    case SchedulingPolicy::Priority:
+        return unique_ptr<Scheduler>(new BasicScheduler<PriorityPolicy>(quantum, sink, cpus));
+    case SchedulingPolicy::ShortestBurst:
+        return unique_ptr<Scheduler>(new BasicScheduler<ShortestBurstPolicy>(quantum, sink, cpus));
+    case SchedulingPolicy::FairShare:
+        return unique_ptr<Scheduler>(new BasicScheduler<FairSharePolicy>(quantum, sink, cpus));
+    case SchedulingPolicy::RoundRobin:
+        break;
+    }
+    return unique_ptr<Scheduler>(new BasicScheduler<RoundRobinPolicy>(quantum, sink, cpus));
 }
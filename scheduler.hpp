@@ -7,54 +7,292 @@
 #ifndef SCHEDULER_H
 #define SCHEDULER_H
 
-#include <deque>
-#include <fstream>
-#include "process.hpp"
+#include <functional>
+#include <memory>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "command.hpp"
+#include "command_buffer.hpp"
+#include "cpu_list.hpp"
+#include "input_reader.hpp"
+#include "metrics.hpp"
+#include "process_table.hpp"
+#include "scheduling_policy.hpp"
+#include "state_sink.hpp"
+#include "timer_wheel.hpp"
 
+// ============================================================
+//
+// Which CPU's ready queue a new process goes on:
+//  Local   - the CPU its parent is running on
+//  Spread  - each CPU in turn
+//
+// ============================================================
+enum class Affinity
+{
+    Local,
+    Spread
+};
+
+bool parse_affinity(const std::string&, Affinity&);
+
+// ============================================================
+//
+// What Scheduler::submit() made of a command:
+//  Ok        - it ran as the next tick
+//  Ignored   - it ran as the next tick but, by the rules of the
+//              input format, had no effect: a wait with nothing
+//              running, a destroy of a PID that isn't the running
+//              process or one of its descendants, an event
+//              nobody waits on, or a create, wait or destroy
+//              while the running process is exiting
+//  Invalid   - it is not a command, so nothing happened
+//  Finished  - the run is already over, so nothing happened
+//
+// ============================================================
+enum class SubmitStatus
+{
+    Ok,
+    Ignored,
+    Invalid,
+    Finished
+};
+
+// ============================================================
+//
+// What the rest of the program sees of a scheduler, whatever
+// its policy. Only whole runs and the sinks' reads of the
+// state go through virtual calls. The simulation itself runs
+// inside BasicScheduler with its policy known at compile time.
+//
+// ============================================================
 class Scheduler
 {
 public:
-    Scheduler(int, std::string, std::string);
+    virtual ~Scheduler() {}
+
+    virtual void run(InputReader&) = 0;
+    virtual void run(InputReader&, size_t) = 0;
+    virtual void run_until(InputReader&, uint64_t) = 0;
+    virtual void run(const CommandBuffer&) = 0;
+    virtual void run(LineSource&) = 0;
+    virtual SubmitStatus submit(const Command&) = 0;
+
+    //True once X has run or the input has run out.
+    virtual bool finished() const = 0;
+
+    //Input lines run so far.
+    virtual size_t commands_run() const = 0;
+
+    //Ticks simulated so far. An "I n" line counts n ticks and X
+    //counts none.
+    virtual uint64_t ticks_run() const = 0;
+
+    virtual void set_reclaim_budget(size_t) = 0;
+    virtual void set_affinity(Affinity) = 0;
+
+    virtual void save(SnapshotWriter&) const = 0;
+    virtual bool restore(SnapshotReader&) = 0;
+
+    virtual unsigned cpu_count() const = 0;
+    virtual const Process & running_process(unsigned) const = 0;
+    virtual const Metrics & get_metrics() const = 0;
+
+    //Visits every live process on a CPU's ready queue in
+    //dispatch order.
+    template<typename Visitor>
+    void for_each_ready(unsigned cpu, Visitor visit) const {
+        VisitorFor<Visitor> visitor(visit);
+        visit_ready(cpu, visitor);
+    }
+
+    //Visits every live process on the wait queue in order.
+    template<typename Visitor>
+    void for_each_waiting(Visitor visit) const {
+        VisitorFor<Visitor> visitor(visit);
+        visit_waiting(visitor);
+    }
+protected:
+    class ProcessVisitor
+    {
+    public:
+        virtual void visit(const Process&) = 0;
+    protected:
+        ~ProcessVisitor() {}
+    };
+
+    template<typename Visitor>
+    class VisitorFor : public ProcessVisitor
+    {
+    public:
+        VisitorFor(Visitor & visitor) : visitor(visitor) {}
+        void visit(const Process & process) { visitor(process); }
+    private:
+        Visitor & visitor;
+    };
+
+    virtual void visit_ready(unsigned, ProcessVisitor&) const = 0;
+    virtual void visit_waiting(ProcessVisitor&) const = 0;
+};
+
+std::unique_ptr<Scheduler> make_scheduler(SchedulingPolicy, int, unsigned, StateSink&);
+
+// ============================================================
+//
+// The simulation, with the ready queues and their ordering left
+// to Policy (see scheduling_policy.hpp). The members are
+// defined in scheduler.cpp, which instantiates one
+// BasicScheduler per policy. It is also the process table's
+// termination sink.
+//
+// The simulation has one or more CPUs, each with its own ready
+// queue and running process. The command of tick t is issued
+// by the process running on CPU t mod the number of CPUs, so a
+// single CPU runs every command as it always has. A CPU left
+// with nothing to run takes the head of its own queue, or
+// steals the head of another CPU's queue if its own is empty.
+//
+// Nothing is done per CPU per tick. A running process is only
+// brought up to date when its CPU is looked at, and the tick it
+// next runs out of burst or quantum is kept in a heap, so a
+// tick only touches the CPU issuing its command and the CPUs
+// with something to do.
+//
+// ============================================================
+template<typename Policy>
+class BasicScheduler : public Scheduler, private TerminationSink
+{
+public:
+    BasicScheduler(int, StateSink&, unsigned);
+
+    void run(InputReader&);
+    void run(InputReader&, size_t);
+    void run_until(InputReader&, uint64_t);
+    void run(const CommandBuffer&);
+    void run(LineSource&);
+    SubmitStatus submit(const Command&);
+
+    bool finished() const { return ended; }
+    size_t commands_run() const { return commands; }
+    uint64_t ticks_run() const { return ticks; }
 
-    void run();
+    void set_reclaim_budget(size_t);
+    void set_affinity(Affinity placement) { affinity = placement; }
+
+    void save(SnapshotWriter&) const;
+    bool restore(SnapshotReader&);
+
+    unsigned cpu_count() const { return cpus.size(); }
+    const Process & running_process(unsigned) const;
+    const Metrics & get_metrics() const { return metrics; }
+protected:
+    void visit_ready(unsigned, ProcessVisitor&) const;
+    void visit_waiting(ProcessVisitor&) const;
 private:
+    struct Cpu
+    {
+        Cpu() : current(IDLE_HANDLE), synced_at(0), expires_at(UINT64_MAX) {}
+
+        //IDLE_HANDLE while nothing is running.
+        ProcessHandle current;
+
+        //The tick current's burst and quantum were last brought
+        //up to date at, and the tick it will run out of one of
+        //them. UINT64_MAX while idle.
+        uint64_t synced_at;
+        uint64_t expires_at;
+    };
+
+    typedef std::pair<uint64_t, unsigned> Expiry;
 
-    int time_quantum;
+    StateSink & sink;
 
-    std::ifstream input_file;
-    std::ofstream output_file;
+    //Maps a PID to its live process so destroy_by_pid doesn't
+    //have to search the process tree.
+    std::unordered_map<int, ProcessHandle> process_index;
 
-    //Using a shared_ptr for the current_process ensures that it
-    //won't unexpectedly get destructed while it is running.
-    std::shared_ptr<Process> current_process;
+    ProcessTable processes;
 
-    std::shared_ptr<Process> idle_process;
+    //Both queues are threaded through the processes, so a
+    //released process unlinks itself without a search.
+    Policy ready_queue;
 
-    //Weak references are used to minimize list queue
-    //searching during termination.
-    std::deque< std::weak_ptr<Process> > ready_queue;
-    std::deque< std::weak_ptr<Process> > wait_queue;
+    std::vector<Cpu> cpus;
 
-    void print_state();
-    void parse_action(const std::string&);
-    void update_current_process();
-    std::shared_ptr<Process> get_next_process();
+    //Every CPU's expires_at, soonest first. Entries left behind
+    //when a CPU's process changes are skipped once they come up.
+    std::priority_queue<Expiry, std::vector<Expiry>, std::greater<Expiry> > expiries;
 
-    void create_process(int, int);
-    void wait_for_event(int);
-    void signal_event(int);
-    void destroy_by_pid(int);
+    //CPUs with nothing running, longest idle first, and CPUs
+    //with something on their ready queue, the next to steal
+    //from first. queued counts every ready queue entry.
+    CpuList idle_cpus;
+    CpuList loaded_cpus;
+    size_t queued;
 
-    void cascading_terminate(Process&);
-    void show_terminate_message(const Process&) ;
+    //The CPU running the current command.
+    unsigned issuing;
 
-    void ready_enqueue(const std::weak_ptr<Process>&);
-    void wait_enqueue(const std::weak_ptr<Process>&);
+    Affinity affinity;
+    unsigned next_spread;
+
+    //wait_queue keeps every waiter in arrival order for printing.
+    //event_waiters links the same processes by event id so an
+    //event finds its first waiter without scanning wait_queue.
+    ProcessList wait_queue;
+    std::unordered_map<int, ProcessList> event_waiters;
+
+    //The deadlines of waits with a timeout, by process slot.
+    TimerWheel timers;
+
+    Metrics metrics;
+
+    //Whether the initial state has been reported, and whether
+    //the run is over. A run can be split over several calls to
+    //run() or resumed from a snapshot.
+    bool begun;
+    bool ended;
+    size_t commands;
+    uint64_t ticks;
+
+    template<typename Input>
+    void run_lines(Input&, size_t, uint64_t);
+
+    void begin();
+    void finish(Metrics::Time);
+    bool run_tick(const Command*, Metrics::Time);
+    bool execute(const Command&);
+    void end_tick();
+    void idle(int);
+    Process & running();
+    void sync(unsigned);
+    void attend(unsigned);
+    void dispatch(unsigned);
+    ProcessHandle get_next_process(unsigned);
+    bool pop_ready(unsigned, ProcessHandle&);
+    void stop(unsigned);
+    void stop_killed();
+    void preempt_expired(unsigned);
+
+    bool create_process(int, int, int);
+    bool create_processes(int, int, int, int);
+    bool wait_for_event(int, int);
+    bool signal_event(const Command&);
+    bool wake_waiters(int, bool);
+    void time_out(uint32_t);
+    bool destroy_by_pid(int);
+
+    void cascading_terminate(ProcessHandle);
+    void terminated(Process&);
+
+    void ready_enqueue(ProcessHandle, unsigned);
+    void wait_enqueue(ProcessHandle);
+    void wait_unlink(Process&);
 
     void error_unrecognized_action(const std::string&);
 };
 
-std::vector<std::string> split_on_space(const std::string&);
-bool is_number_str(const std::string&);
-
 #endif //SCHEDULER_H
@@ -0,0 +1,301 @@
+// File: scheduling_policy.cpp
+// --------------------------------------------------------
+// Class: CS 470                      Instructor: Dr. Hwang
+// Assignment: Process Scheduling     Date Assigned: 22 February 2016
+// Programmer: Evan Higgins           Date Completed: 18 March 2016
+
+#include <algorithm>
+#include <climits>
+#include "scheduling_policy.hpp"
+
+using namespace std;
+
+// ============================================================
+// Function: parse_scheduling_policy(string, SchedulingPolicy&)
+// Returns:  bool
+//
+// Maps a policy name to its SchedulingPolicy. Returns false
+// for an unknown name.
+// ============================================================
+bool parse_scheduling_policy(const string & name, SchedulingPolicy & policy) {
+    if(name == "rr")
+        policy = SchedulingPolicy::RoundRobin;
+    else if(name == "mlfq")
+        policy = SchedulingPolicy::Feedback;
+    else if(name == "priority")
+        policy = SchedulingPolicy::Priority;
+    else if(name == "srb")
+        policy = SchedulingPolicy::ShortestBurst;
+    else if(name == "cfs")
+        policy = SchedulingPolicy::FairShare;
+    else
+        return false;
+    return true;
+}
+
+bool RoundRobinPolicy::pop(unsigned cpu, ProcessHandle & handle) {
+    ProcessList & queue = queues[cpu];
+    if(queue.empty())
+        return false;
+    Process & process = queue.front();
+    handle = process.get_handle();
+    queue.unlink(process);
+    return true;
+}
+
+void RoundRobinPolicy::save(SnapshotWriter & out) const {
+    for(auto & queue : queues)
+        queue.save(out);
+}
+
+bool RoundRobinPolicy::restore(SnapshotReader & in) {
+    bool valid = true;
+    for(auto & queue : queues)
+        valid = queue.restore(in) && valid;
+    return valid;
+}
+
+FeedbackPolicy::FeedbackPolicy(int quantum, ProcessTable & table, unsigned cpus) :
+    time_quantum(quantum),
+    dispatches(cpus, 0),
+    levels(cpus * FEEDBACK_LEVELS, ProcessList(table, QUEUE_LINKS))
+{
+}
+
+void FeedbackPolicy::push(Process & process, unsigned cpu) {
+    Place & place = places[process.get_handle()];
+    place.queued_at = dispatches[cpu];
+    levels[cpu * FEEDBACK_LEVELS + place.level].push_back(process);
+}
+
+// ============================================================
+// Function: pop(unsigned, ProcessHandle&)
+// Returns:  bool
+//
+// Takes the head of cpu's highest nonempty level, after aging.
+// ============================================================
+bool FeedbackPolicy::pop(unsigned cpu, ProcessHandle & handle) {
+    ++dispatches[cpu];
+    age(cpu);
+
+    for(int level = 0; level < FEEDBACK_LEVELS; ++level) {
+        ProcessList & queue = levels[cpu * FEEDBACK_LEVELS + level];
+        if(!queue.empty()) {
+            Process & process = queue.front();
+            handle = process.get_handle();
+            queue.unlink(process);
+            return true;
+        }
+    }
+    return false;
+}
+
+void FeedbackPolicy::remove(Process & process, unsigned cpu) {
+    levels[cpu * FEEDBACK_LEVELS + places[process.get_handle()].level].unlink(process);
+}
+
+size_t FeedbackPolicy::size(unsigned cpu) const {
+    size_t total = 0;
+    for(int level = 0; level < FEEDBACK_LEVELS; ++level)
+        total += levels[cpu * FEEDBACK_LEVELS + level].size();
+    return total;
+}
+
+// ============================================================
+// Function: quantum(const Process&)
+// Returns:  int
+//
+// The base quantum doubled once per level the process has
+// dropped, held at INT_MAX if that no longer fits.
+// ============================================================
+int FeedbackPolicy::quantum(const Process & process) {
+    int level = places[process.get_handle()].level;
+    if(time_quantum > (INT_MAX >> level))
+        return INT_MAX;
+    return time_quantum << level;
+}
+
+void FeedbackPolicy::expired(const Process & process) {
+    int & current = places[process.get_handle()].level;
+    if(current < FEEDBACK_LEVELS - 1)
+        ++current;
+}
+
+void FeedbackPolicy::blocked(const Process & process) {
+    places[process.get_handle()].level = 0;
+}
+
+// ============================================================
+// Function: age(unsigned)
+//
+// Moves every process that has been queued below the top level
+// of cpu for FEEDBACK_AGE_LIMIT of its dispatches to the back
+// of the top level. Each level is in queueing order, so only
+// its head has to be looked at.
+// ============================================================
+void FeedbackPolicy::age(unsigned cpu) {
+    ProcessList * queues = &levels[cpu * FEEDBACK_LEVELS];
+    for(int current = 1; current < FEEDBACK_LEVELS; ++current) {
+        auto & queue = queues[current];
+        while(!queue.empty()) {
+            Process & process = queue.front();
+            Place & place = places[process.get_handle()];
+            if(dispatches[cpu] - place.queued_at < FEEDBACK_AGE_LIMIT)
+                break;
+            queue.unlink(process);
+            place.level = 0;
+            place.queued_at = dispatches[cpu];
+            queues[0].push_back(process);
+        }
+    }
+}
+
+void SortedQueue::push(long long key, const Process & process, unsigned cpu) {
+    ProcessHandle handle = process.get_handle();
+    filed[handle] = make_pair(key, arrivals);
+    queues[cpu].insert(Entry(key, arrivals++, handle));
+}
+
+void SortedQueue::remove(Process & process, unsigned cpu) {
+    ProcessHandle handle = process.get_handle();
+    auto & key = filed[handle];
+    queues[cpu].erase(Entry(key.first, key.second, handle));
+}
+
+void FeedbackPolicy::save(SnapshotWriter & out) const {
+    for(uint64_t count : dispatches)
+        out.put(count);
+    for(auto & level : levels)
+        level.save(out);
+    places.save(out, [](SnapshotWriter & out, const Place & place) {
+                out.put(place.level);
+                out.put(place.queued_at);
+            });
+}
+
+bool FeedbackPolicy::restore(SnapshotReader & in) {
+    for(auto & count : dispatches)
+        count = in.get();
+    bool valid = true;
+    for(auto & level : levels)
+        valid = level.restore(in) && valid;
+    places.restore(in, [&](SnapshotReader & in, Place & place) {
+                uint64_t level = in.get();
+                if(level >= FEEDBACK_LEVELS)
+                    in.fail();
+                place.level = static_cast<int>(level);
+                place.queued_at = in.get();
+            });
+    return valid && in.good();
+}
+
+bool SortedQueue::pop(unsigned cpu, ProcessHandle & handle) {
+    auto & queue = queues[cpu];
+    if(queue.empty())
+        return false;
+    last_key = get<0>(*queue.begin());
+    handle = get<2>(*queue.begin());
+    queue.erase(queue.begin());
+    return true;
+}
+
+void SortedQueue::save(SnapshotWriter & out) const {
+    out.put(arrivals);
+    out.put_signed(last_key);
+    for(auto & queue : queues) {
+        out.put(queue.size());
+        for(auto & entry : queue) {
+            out.put_signed(get<0>(entry));
+            out.put(get<1>(entry));
+            save_handle(out, get<2>(entry));
+        }
+    }
+    filed.save(out, [](SnapshotWriter & out, const pair<long long, uint64_t> & key) {
+                out.put_signed(key.first);
+                out.put(key.second);
+            });
+}
+
+bool SortedQueue::restore(SnapshotReader & in) {
+    arrivals = in.get();
+    last_key = in.get_signed();
+    for(auto & queue : queues) {
+        queue.clear();
+        size_t count = in.get_count();
+        for(size_t i = 0; i < count && in.good(); ++i) {
+            long long key = in.get_signed();
+            uint64_t arrival = in.get();
+            ProcessHandle handle = restore_handle(in);
+            if(handle.index >= table.slot_count())
+                in.fail();
+            queue.insert(Entry(key, arrival, handle));
+        }
+    }
+    filed.restore(in, [](SnapshotReader & in, pair<long long, uint64_t> & key) {
+                key.first = in.get_signed();
+                key.second = in.get();
+            });
+    return in.good();
+}
+
+void FairSharePolicy::push(Process & process, unsigned cpu) {
+    Account & account = accounts[process.get_handle()];
+    if(account.vruntime < min_vruntime[cpu])
+        account.vruntime = min_vruntime[cpu];
+    SortedQueue::push(account.vruntime, process, cpu);
+}
+
+bool FairSharePolicy::pop(unsigned cpu, ProcessHandle & handle) {
+    if(!SortedQueue::pop(cpu, handle))
+        return false;
+    if(last_key > min_vruntime[cpu])
+        min_vruntime[cpu] = last_key;
+    return true;
+}
+
+int FairSharePolicy::quantum(const Process & process) {
+    accounts[process.get_handle()].granted = time_quantum;
+    return time_quantum;
+}
+
+// ============================================================
+// Function: charge(const Process&)
+//
+// Adds the ticks the running process used out of its last
+// quantum, weighted by its priority, to its virtual runtime.
+// The weight is worked out in long long so any int priority
+// fits, and a runtime that would pass the range of long long
+// is held at its end instead.
+// ============================================================
+void FairSharePolicy::charge(const Process & process) {
+    Account & account = accounts[process.get_handle()];
+    long long used = account.granted - max(process.get_remaining_quantum(), 0);
+    long long weight = static_cast<long long>(process.get_priority()) + 1;
+    long long charged;
+    if(__builtin_mul_overflow(used, weight, &charged) ||
+            __builtin_add_overflow(account.vruntime, charged, &account.vruntime))
+        account.vruntime = (used < 0) != (weight < 0) ? LLONG_MIN : LLONG_MAX;
+    account.granted = 0;
+}
+
+void FairSharePolicy::save(SnapshotWriter & out) const {
+    SortedQueue::save(out);
+    for(long long vruntime : min_vruntime)
+        out.put_signed(vruntime);
+    accounts.save(out, [](SnapshotWriter & out, const Account & account) {
+                out.put_signed(account.vruntime);
+                out.put_signed(account.granted);
+            });
+}
+
+bool FairSharePolicy::restore(SnapshotReader & in) {
+    if(!SortedQueue::restore(in))
+        return false;
+    for(auto & vruntime : min_vruntime)
+        vruntime = in.get_signed();
+    accounts.restore(in, [](SnapshotReader & in, Account & account) {
+                account.vruntime = in.get_signed();
+                account.granted = in.get_int();
+            });
+    return in.good();
+}
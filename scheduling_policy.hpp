@@ -0,0 +1,363 @@
+// File: scheduling_policy.hpp
+// --------------------------------------------------------
+// Class: CS 470                      Instructor: Dr. Hwang
+// Assignment: Process Scheduling     Date Assigned: 22 February 2016
+// Programmer: Evan Higgins           Date Completed: 18 March 2016
+
+#ifndef SCHEDULING_POLICY_H
+#define SCHEDULING_POLICY_H
+
+#include <cstdint>
+#include <set>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "process_list.hpp"
+
+// ============================================================
+//
+// A scheduling policy owns the ready queues, one per CPU: it
+// decides the order processes are dispatched in and how long
+// each one runs. Policies are template parameters of
+// BasicScheduler (see scheduler.hpp), so every call below is
+// resolved at compile time. Each policy is constructed from
+// the quantum, the process table and the number of CPUs and
+// provides:
+//
+//  push(process, cpu)     queue a ready process on cpu
+//  pop(cpu, handle)       take the next process to run off
+//                         cpu's queue, false if it is empty
+//  remove(process, cpu)   take a queued process that is being
+//                         released off cpu's queue
+//  size(cpu)              processes queued on cpu
+//  for_each(cpu, visit)   visit the handles queued on cpu in
+//                         dispatch order
+//  quantum(process)       ticks to give a process just dispatched
+//  expired(process)       the running process used up its
+//                         quantum and is about to be queued again
+//  blocked(process)       the running process started waiting
+//  save(out)              write the policy's state to a snapshot
+//  restore(in)            read it back, false if malformed
+//
+// Released processes are removed, so the queue never holds a
+// stale handle. With a reclaim budget a terminated process
+// stays queued until it is released, and the scheduler skips it
+// if it comes up first.
+//
+// What a policy keeps per process is shared by every CPU, so a
+// process keeps it when it is stolen by another CPU.
+//
+// ============================================================
+enum class SchedulingPolicy
+{
+    RoundRobin,
+    Feedback,
+    Priority,
+    ShortestBurst,
+    FairShare
+};
+
+bool parse_scheduling_policy(const std::string&, SchedulingPolicy&);
+
+// ============================================================
+//
+// Per process bookkeeping for a policy, kept beside the
+// process table and indexed the same way. An entry for a slot
+// whose generation has moved on belongs to a terminated
+// process and is reset on first use. A stale handle, older
+// than its slot, gets a scratch entry instead so it can't
+// disturb the process living there now.
+//
+// ============================================================
+template<typename T>
+class PolicySlots
+{
+public:
+    T & operator[](ProcessHandle handle) {
+        if(handle.index >= slots.size())
+            slots.resize(handle.index + 1);
+        Slot & slot = slots[handle.index];
+        if(handle.generation < slot.generation) {
+            scratch = T();
+            return scratch;
+        }
+        if(slot.generation != handle.generation) {
+            slot.generation = handle.generation;
+            slot.data = T();
+        }
+        return slot.data;
+    }
+
+    //Save and Restore write and read a single T.
+    template<typename Save>
+    void save(SnapshotWriter & out, Save save_data) const {
+        out.put(slots.size());
+        for(auto & slot : slots) {
+            out.put(slot.generation);
+            save_data(out, slot.data);
+        }
+    }
+
+    template<typename Restore>
+    void restore(SnapshotReader & in, Restore restore_data) {
+        slots.resize(in.get_count());
+        for(auto & slot : slots) {
+            slot.generation = static_cast<uint32_t>(in.get());
+            restore_data(in, slot.data);
+        }
+    }
+private:
+    struct Slot
+    {
+        Slot() : generation(0), data() {}
+
+        uint32_t generation;
+        T data;
+    };
+
+    std::vector<Slot> slots;
+    T scratch;
+};
+
+// ============================================================
+//
+// FIFO ready queue with a fixed quantum. This is the original
+// scheduler and the one output/ was recorded with.
+//
+// ============================================================
+class RoundRobinPolicy
+{
+public:
+    RoundRobinPolicy(int quantum, ProcessTable & table, unsigned cpus) :
+        time_quantum(quantum), queues(cpus, ProcessList(table, QUEUE_LINKS)) {}
+
+    void push(Process & process, unsigned cpu) { queues[cpu].push_back(process); }
+    bool pop(unsigned, ProcessHandle&);
+    void remove(Process & process, unsigned cpu) { queues[cpu].unlink(process); }
+    size_t size(unsigned cpu) const { return queues[cpu].size(); }
+
+    template<typename Visitor>
+    void for_each(unsigned cpu, Visitor visit) const {
+        queues[cpu].for_each([&](const Process & process) {
+                    visit(process.get_handle());
+                });
+    }
+
+    int quantum(const Process&) { return time_quantum; }
+    void expired(const Process&) {}
+    void blocked(const Process&) {}
+
+    void save(SnapshotWriter&) const;
+    bool restore(SnapshotReader&);
+private:
+    int time_quantum;
+    std::vector<ProcessList> queues;
+};
+
+//Levels of the feedback queue. Level n runs quantum << n ticks.
+#define FEEDBACK_LEVELS 3
+
+//Dispatches a process may sit below the top level before it
+//is aged back up to it.
+#define FEEDBACK_AGE_LIMIT 32
+
+// ============================================================
+//
+// Multilevel feedback queue. Processes start on the top level.
+// Using up a whole quantum moves a process down a level, and
+// each level down runs twice as long but only when every level
+// above it is empty. Waiting on an event moves a process back
+// to the top. A process left queued below the top level for
+// FEEDBACK_AGE_LIMIT dispatches of its CPU is aged back up to
+// the top, so long running processes can't starve.
+//
+// ============================================================
+class FeedbackPolicy
+{
+public:
+    FeedbackPolicy(int, ProcessTable&, unsigned);
+
+    void push(Process&, unsigned);
+    bool pop(unsigned, ProcessHandle&);
+    void remove(Process&, unsigned);
+    size_t size(unsigned) const;
+
+    template<typename Visitor>
+    void for_each(unsigned cpu, Visitor visit) const {
+        for(int level = 0; level < FEEDBACK_LEVELS; ++level)
+            levels[cpu * FEEDBACK_LEVELS + level].for_each(
+                    [&](const Process & process) {
+                        visit(process.get_handle());
+                    });
+    }
+
+    int quantum(const Process&);
+    void expired(const Process&);
+    void blocked(const Process&);
+
+    void save(SnapshotWriter&) const;
+    bool restore(SnapshotReader&);
+private:
+    struct Place
+    {
+        Place() : level(0), queued_at(0) {}
+
+        //The level the process is on, 0 for new processes.
+        int level;
+        uint64_t queued_at;
+    };
+
+    int time_quantum;
+
+    //Each CPU's dispatches so far, and its levels one after
+    //another, FEEDBACK_LEVELS per CPU.
+    std::vector<uint64_t> dispatches;
+    std::vector<ProcessList> levels;
+
+    PolicySlots<Place> places;
+
+    void age(unsigned);
+};
+
+// ============================================================
+//
+// Base for the policies that keep their ready queue sorted by
+// a key, with ties broken by arrival. Queueing, dispatching
+// and removing are all O(log n).
+//
+// ============================================================
+class SortedQueue
+{
+public:
+    bool pop(unsigned, ProcessHandle&);
+    void remove(Process&, unsigned);
+    size_t size(unsigned cpu) const { return queues[cpu].size(); }
+
+    template<typename Visitor>
+    void for_each(unsigned cpu, Visitor visit) const {
+        for(auto & entry : queues[cpu])
+            visit(std::get<2>(entry));
+    }
+
+    void save(SnapshotWriter&) const;
+    bool restore(SnapshotReader&);
+protected:
+    SortedQueue(ProcessTable & table, unsigned cpus) :
+        last_key(0), table(table), arrivals(0), queues(cpus) {}
+
+    //The key of the entry popped last.
+    long long last_key;
+
+    void push(long long, const Process&, unsigned);
+private:
+    typedef std::tuple<long long, uint64_t, ProcessHandle> Entry;
+
+    //Only used to check handles read back from a snapshot.
+    ProcessTable & table;
+
+    struct EntryOrder
+    {
+        bool operator()(const Entry & a, const Entry & b) const {
+            return std::get<0>(a) != std::get<0>(b) ?
+                   std::get<0>(a) < std::get<0>(b) :
+                   std::get<1>(a) < std::get<1>(b);
+        }
+    };
+
+    uint64_t arrivals;
+    std::vector< std::set<Entry, EntryOrder> > queues;
+
+    //The key and arrival each queued process was filed under.
+    PolicySlots< std::pair<long long, uint64_t> > filed;
+};
+
+// ============================================================
+//
+// Static priorities, taken from the optional fourth field of a
+// C command. The lowest priority value runs first and equal
+// priorities take turns like round robin.
+//
+// ============================================================
+class PriorityPolicy : public SortedQueue
+{
+public:
+    PriorityPolicy(int quantum, ProcessTable & table, unsigned cpus) :
+        SortedQueue(table, cpus), time_quantum(quantum) {}
+
+    void push(Process & process, unsigned cpu) {
+        SortedQueue::push(process.get_priority(), process, cpu);
+    }
+
+    int quantum(const Process&) { return time_quantum; }
+    void expired(const Process&) {}
+    void blocked(const Process&) {}
+private:
+    int time_quantum;
+};
+
+// ============================================================
+//
+// Shortest remaining burst first. A process is ordered by its
+// remaining burst as of when it was queued, and still gives up
+// the processor when its quantum runs out.
+//
+// ============================================================
+class ShortestBurstPolicy : public SortedQueue
+{
+public:
+    ShortestBurstPolicy(int quantum, ProcessTable & table, unsigned cpus) :
+        SortedQueue(table, cpus), time_quantum(quantum) {}
+
+    void push(Process & process, unsigned cpu) {
+        SortedQueue::push(process.get_remaining_burst(), process, cpu);
+    }
+
+    int quantum(const Process&) { return time_quantum; }
+    void expired(const Process&) {}
+    void blocked(const Process&) {}
+private:
+    int time_quantum;
+};
+
+// ============================================================
+//
+// Fair sharing in the style of CFS. Every process accumulates
+// virtual runtime while it runs, scaled by its priority plus
+// one, and the process with the least runs next. New and woken
+// processes start at the least virtual runtime still queued on
+// their CPU so they can't monopolise it to catch up.
+//
+// ============================================================
+class FairSharePolicy : public SortedQueue
+{
+public:
+    FairSharePolicy(int quantum, ProcessTable & table, unsigned cpus) :
+        SortedQueue(table, cpus), time_quantum(quantum), min_vruntime(cpus, 0) {}
+
+    void push(Process&, unsigned);
+    bool pop(unsigned, ProcessHandle&);
+
+    int quantum(const Process&);
+    void expired(const Process & process) { charge(process); }
+    void blocked(const Process & process) { charge(process); }
+
+    void save(SnapshotWriter&) const;
+    bool restore(SnapshotReader&);
+private:
+    struct Account
+    {
+        Account() : vruntime(0), granted(0) {}
+
+        long long vruntime;
+        int granted;
+    };
+
+    int time_quantum;
+    std::vector<long long> min_vruntime;
+    PolicySlots<Account> accounts;
+
+    void charge(const Process&);
+};
+
+#endif //SCHEDULING_POLICY_H
@@ -0,0 +1,284 @@
+// File: simulation.cpp
+// --------------------------------------------------------
+// Class: CS 470                      Instructor: Dr. Hwang
+// Assignment: Process Scheduling     Date Assigned: 22 February 2016
+// Programmer: Evan Higgins           Date Completed: 18 March 2016
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include "scheduler.hpp"
+#include "simulation.hpp"
+#include "snapshot_index.hpp"
+#include "state_log.hpp"
+
+using namespace std;
+
+// ============================================================
+// Function: make_sink(const RunOptions&, OutputBuffer&)
+// Returns:  unique_ptr<StateSink>
+//
+// Creates the sink for the output mode in options.
+// ============================================================
+unique_ptr<StateSink> make_sink(const RunOptions & options, OutputBuffer & out) {
+    if(options.output_mode == OutputMode::Binary)
+        return unique_ptr<StateSink>(new BinaryStateSink(out, options.compress));
+    return make_text_sink(options.output_mode, out, options.sample_interval);
+}
+
+// ============================================================
+// Function: simulate(int, const CommandBuffer&, const string&,
+//                    const RunOptions&)
+// Returns:  bool
+//
+// Runs commands with the given quantum and writes the output
+// to the file output. Returns false if it can't be opened.
+// Safe to call from several threads on the same commands.
+// ============================================================
+bool simulate(int quantum,
+              const CommandBuffer & commands,
+              const string & output,
+              const RunOptions & options) {
+    OutputBuffer out(output);
+    if(!out.good()) {
+        cerr << ("[ERROR]: Output file " + output + " did not open correctly.\n");
+        return false;
+    }
+
+    unique_ptr<StateSink> sink = make_sink(options, out);
+    unique_ptr<Scheduler> scheduler = make_scheduler(options.policy, quantum,
+                                                     options.cpus, *sink);
+    scheduler->set_reclaim_budget(options.reclaim_budget);
+    scheduler->set_affinity(options.affinity);
+    scheduler->run(commands);
+
+    sink.reset();
+    out.close();
+    return true;
+}
+
+// ============================================================
+// Function: encode_snapshot(const SnapshotInfo&,
+//                           const Scheduler&)
+// Returns:  string
+//
+// A complete snapshot of scheduler and info.
+// ============================================================
+string encode_snapshot(const SnapshotInfo & info, const Scheduler & scheduler) {
+    SnapshotWriter out;
+    out.put_signed(info.quantum);
+    out.put(static_cast<uint64_t>(info.policy));
+    out.put(info.reclaim_budget);
+    out.put(info.cpus);
+    out.put(static_cast<uint64_t>(info.affinity));
+    out.put(info.input_offset);
+    scheduler.save(out);
+    return out.finish();
+}
+
+// ============================================================
+// Function: decode_snapshot(const string&, const string&,
+//                           SnapshotInfo&, StateSink&)
+// Returns:  unique_ptr<Scheduler>
+//
+// Reads the snapshot data into info and a new scheduler
+// reporting to sink. Returns nullptr, after printing that name
+// is not a valid snapshot, if it is malformed.
+// ============================================================
+unique_ptr<Scheduler> decode_snapshot(const string & data,
+                                      const string & name,
+                                      SnapshotInfo & info,
+                                      StateSink & sink) {
+    SnapshotReader in(data.data(), data.size());
+    info.quantum = in.get_int();
+    uint64_t policy = in.get();
+    info.reclaim_budget = in.get();
+    uint64_t cpus = in.get();
+    uint64_t affinity = in.get();
+    info.input_offset = in.get();
+    if(policy > static_cast<uint64_t>(SchedulingPolicy::FairShare) ||
+            cpus == 0 || cpus > MAX_CPUS ||
+            affinity > static_cast<uint64_t>(Affinity::Spread))
+        in.fail();
+    info.policy = static_cast<SchedulingPolicy>(policy);
+    info.cpus = static_cast<unsigned>(cpus);
+    info.affinity = static_cast<Affinity>(affinity);
+
+    unique_ptr<Scheduler> scheduler;
+    if(in.good()) {
+        scheduler = make_scheduler(info.policy, info.quantum, info.cpus, sink);
+        scheduler->set_reclaim_budget(info.reclaim_budget);
+        scheduler->set_affinity(info.affinity);
+        if(!scheduler->restore(in) || !in.at_end())
+            in.fail();
+    }
+
+    if(!in.good()) {
+        cerr << ("[ERROR]: " + name + " is not a valid snapshot.\n");
+        return nullptr;
+    }
+    return scheduler;
+}
+
+// ============================================================
+// Function: write_snapshot(const string&, const SnapshotInfo&,
+//                          const Scheduler&)
+// Returns:  bool
+//
+// Writes a snapshot of scheduler and info to the file name.
+// Returns false if it can't be written.
+// ============================================================
+bool write_snapshot(const string & name,
+                    const SnapshotInfo & info,
+                    const Scheduler & scheduler) {
+    OutputBuffer file(name);
+    if(!file.good()) {
+        cerr << ("[ERROR]: Snapshot file " + name + " did not open correctly.\n");
+        return false;
+    }
+    string data = encode_snapshot(info, scheduler);
+    file.write(data.data(), data.size());
+    file.close();
+    return true;
+}
+
+// ============================================================
+// Function: read_snapshot(const string&, SnapshotInfo&,
+//                         StateSink&)
+// Returns:  unique_ptr<Scheduler>
+//
+// Reads the snapshot in the file name into info and a new
+// scheduler reporting to sink. Returns nullptr, after printing
+// why, if the file can't be read or isn't a valid snapshot.
+// ============================================================
+unique_ptr<Scheduler> read_snapshot(const string & name,
+                                    SnapshotInfo & info,
+                                    StateSink & sink) {
+    ifstream file(name, ios::binary);
+    if(!file) {
+        cerr << ("[ERROR]: Snapshot file " + name + " did not open correctly.\n");
+        return nullptr;
+    }
+    string data((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+    return decode_snapshot(data, name, info, sink);
+}
+
+// ============================================================
+// Function: run_indexed(Scheduler&, InputReader&, SnapshotInfo,
+//                       uint64_t, const string&)
+// Returns:  bool
+//
+// Runs the rest of input, adding a snapshot to the index file
+// name before the first tick and then each time another
+// interval ticks have run. Returns false if the index can't
+// be written.
+// ============================================================
+bool run_indexed(Scheduler & scheduler,
+                 InputReader & input,
+                 SnapshotInfo info,
+                 uint64_t interval,
+                 const string & name) {
+    SnapshotIndexWriter index(name);
+    if(!index.good()) {
+        cerr << ("[ERROR]: Snapshot index " + name + " did not open correctly.\n");
+        return false;
+    }
+
+    while(!scheduler.finished()) {
+        info.input_offset = input.offset();
+        index.add(scheduler.ticks_run(), encode_snapshot(info, scheduler));
+        scheduler.run_until(input, (scheduler.ticks_run() / interval + 1) * interval);
+    }
+    index.finish();
+    return true;
+}
+
+// ============================================================
+// Function: read_snapshot_at(const string&, uint64_t,
+//                            SnapshotInfo&, StateSink&)
+// Returns:  unique_ptr<Scheduler>
+//
+// Like read_snapshot(), but takes the snapshot in the index
+// file name closest to tick without being past it.
+// ============================================================
+unique_ptr<Scheduler> read_snapshot_at(const string & name,
+                                       uint64_t tick,
+                                       SnapshotInfo & info,
+                                       StateSink & sink) {
+    string data;
+    if(!read_indexed_snapshot(name, tick, data))
+        return nullptr;
+    unique_ptr<Scheduler> scheduler = decode_snapshot(data, name, info, sink);
+    if(scheduler && scheduler->ticks_run() > tick) {
+        cerr << ("[ERROR]: " + name + " is not a valid snapshot index.\n");
+        return nullptr;
+    }
+    return scheduler;
+}
+
+// ============================================================
+// Function: parse_quantum_list(const string&, vector<int>&)
+// Returns:  bool
+//
+// Parses a comma separated list of quanta and quantum ranges,
+// such as "1,5,10" or "1-4,8", onto the end of quanta. Returns
+// false if the list is malformed or would leave quanta with
+// more than SWEEP_QUANTA_MAX entries.
+// ============================================================
+bool parse_quantum_list(const string & list, vector<int> & quanta) {
+    size_t begin = 0;
+    while(begin <= list.size()) {
+        size_t end = list.find(',', begin);
+        if(end == string::npos)
+            end = list.size();
+
+        const char * item = list.data() + begin;
+        const char * item_end = list.data() + end;
+        const char * dash = item;
+        while(dash != item_end && *dash != '-')
+            ++dash;
+
+        int first, last;
+        if(!parse_int(item, dash, first))
+            return false;
+        if(dash == item_end)
+            last = first;
+        else if(!parse_int(dash + 1, item_end, last) || last < first)
+            return false;
+
+        long long count = static_cast<long long>(last) - first + 1;
+        if(count > SWEEP_QUANTA_MAX - static_cast<long long>(quanta.size()))
+            return false;
+
+        //Stopping at last rather than past it, so a range can end
+        //at INT_MAX.
+        for(int quantum = first; ; ++quantum) {
+            quanta.push_back(quantum);
+            if(quantum == last)
+                break;
+        }
+        begin = end + 1;
+    }
+    return true;
+}
+
+// ============================================================
+// Function: sweep_output_name(const string&, int)
+// Returns:  string
+//
+// The output file for one quantum of a sweep: pattern with
+// every "%q" replaced by the quantum.
+// ============================================================
+string sweep_output_name(const string & pattern, int quantum) {
+    string name;
+    size_t begin = 0;
+    for(size_t found = pattern.find("%q");
+            found != string::npos;
+            found = pattern.find("%q", begin)) {
+        name.append(pattern, begin, found - begin);
+        name += to_string(quantum);
+        begin = found + 2;
+    }
+    name.append(pattern, begin, string::npos);
+    return name;
+}
@@ -0,0 +1,147 @@
+// File: simulation.hpp
+// --------------------------------------------------------
+// Class: CS 470                      Instructor: Dr. Hwang
+// Assignment: Process Scheduling     Date Assigned: 22 February 2016
+// Programmer: Evan Higgins           Date Completed: 18 March 2016
+
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "command_buffer.hpp"
+#include "input_reader.hpp"
+#include "output_buffer.hpp"
+#include "scheduler.hpp"
+#include "scheduling_policy.hpp"
+#include "state_sink.hpp"
+#include "text_sink.hpp"
+
+// ============================================================
+//
+// Everything about a run other than its quantum, input and
+// output, as set on the command line.
+//
+// ============================================================
+struct RunOptions
+{
+    RunOptions() :
+        reclaim_budget(0),
+        output_mode(OutputMode::Full),
+        sample_interval(100),
+        compress(false),
+        policy(SchedulingPolicy::RoundRobin),
+        cpus(1),
+        affinity(Affinity::Local) {}
+
+    size_t reclaim_budget;
+    OutputMode output_mode;
+    long sample_interval;
+    bool compress;
+    SchedulingPolicy policy;
+    unsigned cpus;
+    Affinity affinity;
+};
+
+std::unique_ptr<StateSink> make_sink(const RunOptions&, OutputBuffer&);
+
+bool simulate(int, const CommandBuffer&, const std::string&, const RunOptions&);
+
+// ============================================================
+//
+// What a snapshot records about its run besides the scheduler
+// (see snapshot.hpp). A snapshot only resumes correctly with
+// the same input and the same parameters it was taken with.
+//
+// ============================================================
+struct SnapshotInfo
+{
+    int quantum;
+    SchedulingPolicy policy;
+    size_t reclaim_budget;
+    unsigned cpus;
+    Affinity affinity;
+
+    //InputReader::offset() of the line after the last one run.
+    size_t input_offset;
+};
+
+std::string encode_snapshot(const SnapshotInfo&, const Scheduler&);
+std::unique_ptr<Scheduler> decode_snapshot(const std::string&, const std::string&,
+                                           SnapshotInfo&, StateSink&);
+
+bool write_snapshot(const std::string&, const SnapshotInfo&, const Scheduler&);
+std::unique_ptr<Scheduler> read_snapshot(const std::string&, SnapshotInfo&, StateSink&);
+
+bool run_indexed(Scheduler&, InputReader&, SnapshotInfo, uint64_t, const std::string&);
+std::unique_ptr<Scheduler> read_snapshot_at(const std::string&, uint64_t,
+                                            SnapshotInfo&, StateSink&);
+
+// ============================================================
+//
+// Passes everything on to another sink, except while muted,
+// as it is to begin with. Used to replay up to a point without
+// writing any output.
+//
+// ============================================================
+class MutedSink : public StateSink
+{
+public:
+    MutedSink(StateSink & target) : target(target), muted(true) {}
+
+    void set_muted(bool mute) { muted = mute; }
+
+    void command(const char * text, size_t length) {
+        if(!muted)
+            target.command(text, length);
+    }
+    void created(const Process & process) {
+        if(!muted)
+            target.created(process);
+    }
+    void ready_enqueued(const Process & process) {
+        if(!muted)
+            target.ready_enqueued(process);
+    }
+    void wait_enqueued(const Process & process) {
+        if(!muted)
+            target.wait_enqueued(process);
+    }
+    void dispatched(const Process & process) {
+        if(!muted)
+            target.dispatched(process);
+    }
+    void woken(const Process & process) {
+        if(!muted)
+            target.woken(process);
+    }
+    void killed(const Process & process) {
+        if(!muted)
+            target.killed(process);
+    }
+    void terminated(const Process & process) {
+        if(!muted)
+            target.terminated(process);
+    }
+    void state(const Scheduler & scheduler) {
+        if(!muted)
+            target.state(scheduler);
+    }
+    void finish(const Scheduler & scheduler) {
+        if(!muted)
+            target.finish(scheduler);
+    }
+private:
+    StateSink & target;
+    bool muted;
+};
+
+//Most quanta a --sweep list may name, counting each quantum
+//of a range.
+#define SWEEP_QUANTA_MAX 4096
+
+bool parse_quantum_list(const std::string&, std::vector<int>&);
+std::string sweep_output_name(const std::string&, int);
+
+#endif //SIMULATION_H
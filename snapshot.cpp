@@ -0,0 +1,133 @@
+// File: snapshot.cpp
+// --------------------------------------------------------
+// Class: CS 470                      Instructor: Dr. Hwang
+// Assignment: Process Scheduling     Date Assigned: 22 February 2016
+// Programmer: Evan Higgins           Date Completed: 18 March 2016
+
+#include <climits>
+#include <cstring>
+#include <zlib.h>
+#include "binary_trace.hpp"
+#include "snapshot.hpp"
+
+using namespace std;
+
+SnapshotWriter::SnapshotWriter() :
+    bytes(SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_SIZE)
+{
+    bytes.push_back(SNAPSHOT_VERSION & 0xFF);
+    bytes.append(3, '\0');
+    bytes.append(4, '\0');
+}
+
+void SnapshotWriter::put(uint64_t value) {
+    append_varint(bytes, value);
+}
+
+void SnapshotWriter::put_signed(int64_t value) {
+    uint64_t bits = static_cast<uint64_t>(value);
+    put((bits << 1) ^ (value < 0 ? UINT64_MAX : 0));
+}
+
+// ============================================================
+// Function: put_index(uint32_t)
+//
+// Writes a slot index plus one, wrapping NO_SLOT (and the
+// index of IDLE_HANDLE) around to 0.
+// ============================================================
+void SnapshotWriter::put_index(uint32_t index) {
+    put(static_cast<uint32_t>(index + 1));
+}
+
+namespace {
+
+uint32_t checksum(const char * data, size_t size) {
+    return crc32(crc32(0, Z_NULL, 0),
+                 reinterpret_cast<const Bytef*>(data + SNAPSHOT_HEADER_SIZE),
+                 size - SNAPSHOT_HEADER_SIZE);
+}
+
+}
+
+// ============================================================
+// Function: finish()
+// Returns:  const string&
+//
+// Fills in the checksum and returns the whole snapshot.
+// ============================================================
+const string & SnapshotWriter::finish() {
+    uint32_t crc = checksum(bytes.data(), bytes.size());
+    for(int i = 0; i < 4; ++i)
+        bytes[SNAPSHOT_MAGIC_SIZE + 4 + i] = static_cast<char>(crc >> (8 * i));
+    return bytes;
+}
+
+// ============================================================
+// Function: SnapshotReader(const char*, size_t)
+//
+// Starts reading right after the header. The reader is failed
+// from the start if data doesn't begin with a snapshot header
+// of a version this build understands or fails its checksum.
+// ============================================================
+SnapshotReader::SnapshotReader(const char * data, size_t size) :
+    cursor(data + SNAPSHOT_HEADER_SIZE),
+    end(data + size),
+    ok(true)
+{
+    if(size < SNAPSHOT_HEADER_SIZE ||
+            memcmp(data, SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_SIZE) != 0 ||
+            static_cast<uint8_t>(data[SNAPSHOT_MAGIC_SIZE]) != SNAPSHOT_VERSION) {
+        ok = false;
+        cursor = end;
+        return;
+    }
+
+    const uint8_t * stored = reinterpret_cast<const uint8_t*>(data + SNAPSHOT_MAGIC_SIZE + 4);
+    uint32_t crc = stored[0] | stored[1] << 8 | stored[2] << 16 |
+                   static_cast<uint32_t>(stored[3]) << 24;
+    if(crc != checksum(data, size)) {
+        ok = false;
+        cursor = end;
+    }
+}
+
+uint64_t SnapshotReader::get() {
+    uint64_t value;
+    if(!ok || !read_varint(cursor, end, value)) {
+        ok = false;
+        return 0;
+    }
+    return value;
+}
+
+int64_t SnapshotReader::get_signed() {
+    uint64_t zigzag = get();
+    return static_cast<int64_t>((zigzag >> 1) ^ -(zigzag & 1));
+}
+
+uint32_t SnapshotReader::get_index() {
+    uint64_t value = get();
+    if(value > UINT32_MAX) {
+        ok = false;
+        return 0;
+    }
+    return static_cast<uint32_t>(value) - 1;
+}
+
+size_t SnapshotReader::get_count() {
+    uint64_t value = get();
+    if(value > static_cast<uint64_t>(end - cursor)) {
+        ok = false;
+        return 0;
+    }
+    return static_cast<size_t>(value);
+}
+
+int SnapshotReader::get_int() {
+    int64_t value = get_signed();
+    if(value < INT_MIN || value > INT_MAX) {
+        ok = false;
+        return 0;
+    }
+    return static_cast<int>(value);
+}
@@ -0,0 +1,87 @@
+// File: snapshot.hpp
+// --------------------------------------------------------
+// Class: CS 470                      Instructor: Dr. Hwang
+// Assignment: Process Scheduling     Date Assigned: 22 February 2016
+// Programmer: Evan Higgins           Date Completed: 18 March 2016
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// ============================================================
+//
+// Snapshot format, version 3.
+//
+// A snapshot starts with a 16 byte header:
+//  bytes 0-7    magic "SCHEDSNP"
+//  bytes 8-11   format version, little endian
+//  bytes 12-15  CRC-32 of everything after the header, little
+//               endian
+//
+// followed by the complete state of a simulation as a sequence
+// of varints (see binary_trace.hpp), in the order the classes
+// holding the state save it: first the run's parameters and
+// input offset (see write_snapshot in simulation.hpp), then the
+// scheduler. Signed values are zigzag encoded. Slot indices are
+// stored plus one, so the NO_SLOT and idle markers take a
+// single byte.
+//
+// ============================================================
+
+#define SNAPSHOT_MAGIC "SCHEDSNP"
+#define SNAPSHOT_MAGIC_SIZE 8
+#define SNAPSHOT_VERSION 4
+#define SNAPSHOT_HEADER_SIZE 16
+
+class SnapshotWriter
+{
+public:
+    SnapshotWriter();
+
+    void put(uint64_t);
+    void put_signed(int64_t);
+    void put_index(uint32_t);
+
+    const std::string & finish();
+private:
+    std::string bytes;
+};
+
+// ============================================================
+//
+// Reads back what a SnapshotWriter wrote. A snapshot whose
+// header or checksum doesn't match fails right away. Reads past the end
+// or of malformed values return 0 and mark the reader failed,
+// so restoring code can read everything it expects and check
+// good() once at the end. Code that finds a value it can't use
+// calls fail() itself.
+//
+// ============================================================
+class SnapshotReader
+{
+public:
+    SnapshotReader(const char*, size_t);
+
+    uint64_t get();
+    int64_t get_signed();
+    uint32_t get_index();
+
+    //The number of items that follow. Every item takes at least
+    //a byte, so a count larger than what is left is malformed.
+    size_t get_count();
+
+    int get_int();
+
+    bool good() const { return ok; }
+    bool at_end() const { return cursor == end; }
+    void fail() { ok = false; }
+private:
+    const char * cursor;
+    const char * end;
+    bool ok;
+};
+
+#endif //SNAPSHOT_H
@@ -0,0 +1,155 @@
+// File: snapshot_index.cpp
+// --------------------------------------------------------
+// Class: CS 470                      Instructor: Dr. Hwang
+// Assignment: Process Scheduling     Date Assigned: 22 February 2016
+// Programmer: Evan Higgins           Date Completed: 18 March 2016
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include "binary_trace.hpp"
+#include "snapshot_index.hpp"
+
+using namespace std;
+
+// ============================================================
+// Function: SnapshotIndexWriter(const string&)
+//
+// Creates the index file name and writes its header. good()
+// is false if the file could not be opened.
+// ============================================================
+SnapshotIndexWriter::SnapshotIndexWriter(const string & name) :
+    out(name),
+    written(SNAPSHOT_INDEX_HEADER_SIZE)
+{
+    char header[SNAPSHOT_INDEX_HEADER_SIZE] = {};
+    memcpy(header, SNAPSHOT_INDEX_MAGIC, SNAPSHOT_INDEX_MAGIC_SIZE);
+    header[SNAPSHOT_INDEX_MAGIC_SIZE] = SNAPSHOT_INDEX_VERSION;
+    out.write(header, sizeof(header));
+}
+
+// ============================================================
+// Function: add(uint64_t, const string&)
+//
+// Appends a snapshot taken at tick. Snapshots must be added in
+// the order they were taken.
+// ============================================================
+void SnapshotIndexWriter::add(uint64_t tick, const string & snapshot) {
+    Entry entry = { tick, written, snapshot.size() };
+    entries.push_back(entry);
+    out.write(snapshot.data(), snapshot.size());
+    written += snapshot.size();
+}
+
+// ============================================================
+// Function: finish()
+//
+// Writes the table and trailer and closes the file.
+// ============================================================
+void SnapshotIndexWriter::finish() {
+    string table;
+    append_varint(table, entries.size());
+    for(auto & entry : entries) {
+        append_varint(table, entry.tick);
+        append_varint(table, entry.offset);
+        append_varint(table, entry.size);
+    }
+    for(int i = 0; i < SNAPSHOT_INDEX_TRAILER_SIZE; ++i)
+        table.push_back(static_cast<char>(written >> (8 * i)));
+
+    out.write(table.data(), table.size());
+    out.close();
+}
+
+namespace {
+
+bool read_at(ifstream & file, uint64_t offset, size_t size, string & data) {
+    data.resize(size);
+    file.seekg(offset);
+    return file.read(&data[0], size) && file.gcount() == static_cast<streamsize>(size);
+}
+
+// ============================================================
+// Function: find_snapshot(ifstream&, uint64_t, string&)
+// Returns:  bool
+//
+// Reads the last snapshot in an index taken at or before tick
+// into snapshot. Returns false if the index is malformed or
+// has no such snapshot.
+// ============================================================
+bool find_snapshot(ifstream & file, uint64_t tick, string & snapshot) {
+    file.seekg(0, ios::end);
+    uint64_t size = file.tellg();
+    if(size < SNAPSHOT_INDEX_HEADER_SIZE + SNAPSHOT_INDEX_TRAILER_SIZE)
+        return false;
+
+    string header;
+    if(!read_at(file, 0, SNAPSHOT_INDEX_HEADER_SIZE, header) ||
+            memcmp(header.data(), SNAPSHOT_INDEX_MAGIC, SNAPSHOT_INDEX_MAGIC_SIZE) != 0 ||
+            header[SNAPSHOT_INDEX_MAGIC_SIZE] != SNAPSHOT_INDEX_VERSION)
+        return false;
+
+    uint64_t table_end = size - SNAPSHOT_INDEX_TRAILER_SIZE;
+    string trailer;
+    if(!read_at(file, table_end, SNAPSHOT_INDEX_TRAILER_SIZE, trailer))
+        return false;
+    uint64_t table_offset = 0;
+    for(int i = SNAPSHOT_INDEX_TRAILER_SIZE - 1; i >= 0; --i)
+        table_offset = table_offset << 8 | static_cast<uint8_t>(trailer[i]);
+    if(table_offset < SNAPSHOT_INDEX_HEADER_SIZE || table_offset > table_end)
+        return false;
+
+    string table;
+    if(!read_at(file, table_offset, table_end - table_offset, table))
+        return false;
+
+    //Entries are in tick order, so the one wanted is the last
+    //that isn't past tick.
+    const char * cursor = table.data();
+    const char * end = cursor + table.size();
+    uint64_t count;
+    if(!read_varint(cursor, end, count))
+        return false;
+    bool found = false;
+    uint64_t offset = 0, length = 0;
+    for(uint64_t i = 0; i < count; ++i) {
+        uint64_t entry_tick, entry_offset, entry_size;
+        if(!read_varint(cursor, end, entry_tick) ||
+                !read_varint(cursor, end, entry_offset) ||
+                !read_varint(cursor, end, entry_size) ||
+                entry_offset < SNAPSHOT_INDEX_HEADER_SIZE ||
+                entry_size > table_offset - entry_offset)
+            return false;
+        if(entry_tick > tick)
+            break;
+        found = true;
+        offset = entry_offset;
+        length = entry_size;
+    }
+
+    return found && read_at(file, offset, length, snapshot);
+}
+
+}
+
+// ============================================================
+// Function: read_indexed_snapshot(const string&, uint64_t,
+//                                 string&)
+// Returns:  bool
+//
+// Reads the snapshot in the index file name closest to tick
+// without being past it. Returns false, after printing why, if
+// there is none or the file can't be read.
+// ============================================================
+bool read_indexed_snapshot(const string & name, uint64_t tick, string & snapshot) {
+    ifstream file(name, ios::binary);
+    if(!file) {
+        cerr << ("[ERROR]: Snapshot index " + name + " did not open correctly.\n");
+        return false;
+    }
+    if(!find_snapshot(file, tick, snapshot)) {
+        cerr << ("[ERROR]: " + name + " is not a valid snapshot index.\n");
+        return false;
+    }
+    return true;
+}
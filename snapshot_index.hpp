@@ -0,0 +1,66 @@
+// File: snapshot_index.hpp
+// --------------------------------------------------------
+// Class: CS 470                      Instructor: Dr. Hwang
+// Assignment: Process Scheduling     Date Assigned: 22 February 2016
+// Programmer: Evan Higgins           Date Completed: 18 March 2016
+
+#ifndef SNAPSHOT_INDEX_H
+#define SNAPSHOT_INDEX_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "output_buffer.hpp"
+
+// ============================================================
+//
+// Snapshot index format, version 1.
+//
+// An index holds snapshots taken at intervals during one run,
+// so a later run can start from whichever is closest to the
+// tick it wants. It starts with a 16 byte header:
+//  bytes 0-7    magic "SCHEDIDX"
+//  bytes 8-11   format version, little endian
+//  bytes 12-15  reserved, zero
+//
+// followed by the snapshots themselves (see snapshot.hpp), back
+// to back in the order they were taken. After the last one
+// comes the table: a varint count, then for each snapshot the
+// tick it was taken at, its offset from the start of the file
+// and its size, all varints. The file ends with the offset of
+// the table as a little endian uint64, so a reader only has to
+// read the table and the one snapshot it picks.
+//
+// ============================================================
+
+#define SNAPSHOT_INDEX_MAGIC "SCHEDIDX"
+#define SNAPSHOT_INDEX_MAGIC_SIZE 8
+#define SNAPSHOT_INDEX_VERSION 1
+#define SNAPSHOT_INDEX_HEADER_SIZE 16
+#define SNAPSHOT_INDEX_TRAILER_SIZE 8
+
+class SnapshotIndexWriter
+{
+public:
+    SnapshotIndexWriter(const std::string&);
+
+    bool good() const { return out.good(); }
+
+    void add(uint64_t, const std::string&);
+    void finish();
+private:
+    struct Entry
+    {
+        uint64_t tick;
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    OutputBuffer out;
+    uint64_t written;
+    std::vector<Entry> entries;
+};
+
+bool read_indexed_snapshot(const std::string&, uint64_t, std::string&);
+
+#endif //SNAPSHOT_INDEX_H
@@ -0,0 +1,103 @@
+// File: spsc_ring.hpp
+// --------------------------------------------------------
+// Class: CS 470                      Instructor: Dr. Hwang
+// Assignment: Process Scheduling     Date Assigned: 22 February 2016
+// Programmer: Evan Higgins           Date Completed: 18 March 2016
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+//Assumed size of a cache line, so the two ends of a ring don't
+//share one.
+#define CACHE_LINE_SIZE 64
+
+// ============================================================
+//
+// A fixed ring of slots passed from one producer thread to one
+// consumer thread without locks. Slots are filled and drained
+// in place and then reused, so whatever memory a slot holds
+// (a string's buffer, say) is kept from one lap to the next.
+//
+// The producer takes the next free slot with acquire(), fills
+// it and hands it over with publish(). The consumer looks at
+// the oldest published slot with peek() and gives it back with
+// release(). Either side waits while the ring is full or empty,
+// spinning briefly and then yielding.
+//
+// Either side may close() the ring. From then on acquire()
+// returns nullptr, and peek() does too once the slots already
+// published have been drained.
+//
+// ============================================================
+template<typename T>
+class SpscRing
+{
+public:
+    //capacity is rounded up to a power of two.
+    SpscRing(size_t capacity) : head(0), tail(0), closed(false) {
+        size_t size = 1;
+        while(size < capacity)
+            size <<= 1;
+        slots.resize(size);
+        mask = size - 1;
+    }
+
+    T * acquire() {
+        size_t next = tail.load(std::memory_order_relaxed);
+        for(unsigned spins = 0;; ++spins) {
+            if(closed.load(std::memory_order_acquire))
+                return nullptr;
+            if(next - head.load(std::memory_order_acquire) < slots.size())
+                return &slots[next & mask];
+            wait(spins);
+        }
+    }
+
+    void publish() {
+        tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    T * peek() {
+        size_t next = head.load(std::memory_order_relaxed);
+        for(unsigned spins = 0;; ++spins) {
+            //closed is read first, so a close() that follows the
+            //last publish() can't hide that slot.
+            bool done = closed.load(std::memory_order_acquire);
+            if(tail.load(std::memory_order_acquire) != next)
+                return &slots[next & mask];
+            if(done)
+                return nullptr;
+            wait(spins);
+        }
+    }
+
+    void release() {
+        head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    void close() { closed.store(true, std::memory_order_release); }
+private:
+    std::vector<T> slots;
+    size_t mask;
+
+    //Counts of slots released by the consumer and published by
+    //the producer. Each is only written by its own side.
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> head;
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail;
+    alignas(CACHE_LINE_SIZE) std::atomic<bool> closed;
+
+    static void wait(unsigned spins) {
+        if(spins >= 64)
+            std::this_thread::yield();
+    }
+
+    SpscRing(const SpscRing&);
+    SpscRing& operator=(const SpscRing&);
+};
+
+#endif //SPSC_RING_H
@@ -0,0 +1,545 @@
+// File: state_log.cpp
+// --------------------------------------------------------
+// Class: CS 470                      Instructor: Dr. Hwang
+// Assignment: Process Scheduling     Date Assigned: 22 February 2016
+// Programmer: Evan Higgins           Date Completed: 18 March 2016
+
+#include <algorithm>
+#include <cstring>
+#include <zlib.h>
+#include "binary_trace.hpp"
+#include "scheduler.hpp"
+#include "state_log.hpp"
+
+//Uncompressed bytes collected before a block is written out.
+#define STATE_LOG_BLOCK_SIZE (1 << 20)
+
+using namespace std;
+
+namespace {
+
+void append_u32(string & out, uint32_t value) {
+    for(int i = 0; i < 4; ++i)
+        out.push_back(static_cast<char>(value >> (8 * i)));
+}
+
+uint32_t read_u32(const char * data) {
+    const uint8_t * bytes = reinterpret_cast<const uint8_t*>(data);
+    return bytes[0] | bytes[1] << 8 | bytes[2] << 16 |
+           static_cast<uint32_t>(bytes[3]) << 24;
+}
+
+bool read_slot(const char *& cursor, const char * end, uint32_t & slot) {
+    uint64_t value;
+    if(!read_varint(cursor, end, value) || value >= UINT32_MAX)
+        return false;
+    slot = static_cast<uint32_t>(value);
+    return true;
+}
+
+bool read_signed(const char *& cursor, const char * end, int & value) {
+    uint64_t zigzag;
+    if(!read_varint(cursor, end, zigzag) || zigzag > UINT32_MAX)
+        return false;
+    value = static_cast<int>((zigzag >> 1) ^ -(zigzag & 1));
+    return true;
+}
+
+bool is_command_opcode(char opcode) {
+    return strchr("CPBDWOEMINXR", opcode) != nullptr;
+}
+
+}
+
+BinaryStateSink::BinaryStateSink(OutputBuffer & out, bool compress) :
+    out(&out),
+    compress(compress),
+    block_limit(STATE_LOG_BLOCK_SIZE),
+    last_running(IDLE_HANDLE),
+    last_burst(0),
+    last_quantum(0)
+{
+    string header(STATE_LOG_MAGIC, STATE_LOG_MAGIC_SIZE);
+    append_u32(header, STATE_LOG_VERSION);
+    append_u32(header, compress ? STATE_LOG_COMPRESSED : 0);
+    out.write(header.data(), header.size());
+}
+
+BinaryStateSink::BinaryStateSink(size_t block_limit) :
+    out(nullptr),
+    compress(false),
+    block_limit(block_limit),
+    last_running(IDLE_HANDLE),
+    last_burst(0),
+    last_quantum(0)
+{
+}
+
+BinaryStateSink::~BinaryStateSink() {
+    flush();
+}
+
+void BinaryStateSink::write_records(string & records) {
+    out->write(records.data(), records.size());
+}
+
+void BinaryStateSink::command(const char * line, size_t length) {
+    append_trace_record(block, line, length);
+    end_record();
+}
+
+void BinaryStateSink::created(const Process & process) {
+    block.push_back('n');
+    append_slot(process);
+    ProcessHandle parent = process.get_parent();
+    append_varint(block, parent == IDLE_HANDLE ? 0 : parent.index + 1);
+    end_record();
+}
+
+void BinaryStateSink::ready_enqueued(const Process & process) {
+    block.push_back('r');
+    append_slot(process);
+    append_signed(process.get_PID());
+    append_signed(process.get_remaining_burst());
+    end_record();
+}
+
+void BinaryStateSink::wait_enqueued(const Process & process) {
+    block.push_back('w');
+    append_slot(process);
+    append_signed(process.get_PID());
+    append_signed(process.get_remaining_burst());
+    append_signed(process.get_waiting_on());
+    end_record();
+}
+
+void BinaryStateSink::dispatched(const Process & process) {
+    block.push_back('d');
+    append_slot(process);
+    end_record();
+}
+
+void BinaryStateSink::woken(const Process & process) {
+    block.push_back('k');
+    append_slot(process);
+    end_record();
+}
+
+void BinaryStateSink::killed(const Process & process) {
+    block.push_back('x');
+    append_slot(process);
+    end_record();
+}
+
+void BinaryStateSink::terminated(const Process & process) {
+    block.push_back('t');
+    append_slot(process);
+    append_signed(process.get_PID());
+    append_signed(process.get_remaining_burst());
+    end_record();
+}
+
+void BinaryStateSink::state(const Scheduler & scheduler) {
+    append_running(scheduler.running_process(0));
+    end_record();
+}
+
+void BinaryStateSink::finish(const Scheduler & scheduler) {
+    block.push_back('F');
+    append_running(scheduler.running_process(0));
+    flush();
+}
+
+// ============================================================
+// Function: flush()
+//
+// Writes out the records collected so far, compressing them
+// into one block if this log is compressed.
+// ============================================================
+void BinaryStateSink::flush() {
+    if(block.empty())
+        return;
+
+    if(!compress) {
+        write_records(block);
+        block.clear();
+        return;
+    }
+
+    uLongf compressed_size = compressBound(block.size());
+    compressed.resize(8 + compressed_size);
+    compress2(reinterpret_cast<Bytef*>(&compressed[8]),
+              &compressed_size,
+              reinterpret_cast<const Bytef*>(block.data()),
+              block.size(),
+              Z_DEFAULT_COMPRESSION);
+
+    string sizes;
+    append_u32(sizes, block.size());
+    append_u32(sizes, compressed_size);
+    compressed.replace(0, 8, sizes);
+    out->write(compressed.data(), 8 + compressed_size);
+    block.clear();
+}
+
+void BinaryStateSink::append_slot(const Process & process) {
+    append_varint(block, process.get_handle().index);
+}
+
+// ============================================================
+// Function: append_signed(int)
+//
+// Appends a zigzag encoded varint, which keeps small negative
+// values as short as small positive ones.
+// ============================================================
+void BinaryStateSink::append_signed(int value) {
+    uint32_t bits = static_cast<uint32_t>(value);
+    append_varint(block, (bits << 1) ^ (value < 0 ? UINT32_MAX : 0));
+}
+
+// ============================================================
+// Function: append_running(const Process&)
+//
+// Appends the end of tick record. Most ticks either leave the
+// running process alone or tick it once, and those take a
+// single byte.
+// ============================================================
+void BinaryStateSink::append_running(const Process & process) {
+    ProcessHandle handle = process.is_idle() ? IDLE_HANDLE : process.get_handle();
+    int burst = process.get_remaining_burst();
+    int quantum = process.get_remaining_quantum();
+
+    if(handle == last_running && burst == last_burst && quantum == last_quantum) {
+        block.push_back('U');
+    } else if(handle == last_running &&
+              burst == last_burst - 1 && quantum == last_quantum - 1) {
+        block.push_back('T');
+    } else {
+        block.push_back('S');
+        if(handle == IDLE_HANDLE) {
+            append_varint(block, 0);
+        } else {
+            append_varint(block, handle.index + 1);
+            append_signed(process.get_PID());
+            append_signed(burst);
+            append_signed(quantum);
+        }
+    }
+
+    last_running = handle;
+    last_burst = burst;
+    last_quantum = quantum;
+}
+
+void BinaryStateSink::end_record() {
+    if(block.size() >= block_limit)
+        flush();
+}
+
+StateLogDecoder::StateLogDecoder(OutputBuffer & out) :
+    out(out),
+    messages(out),
+    dead_roots(0),
+    orphans(0),
+    releases(0),
+    idle(Process::idle_process()),
+    running(0, 0, IDLE_HANDLE),
+    running_idle(true),
+    final_state(false)
+{
+}
+
+const Process & StateLogDecoder::running_process(unsigned) const {
+    if(running_idle)
+        return idle;
+    return running;
+}
+
+// ============================================================
+// Function: decode(const char*, size_t)
+// Returns:  bool
+//
+// Decodes a whole state log and writes its Full text form.
+// Returns false if the log is not a state log or is corrupt.
+// ============================================================
+bool StateLogDecoder::decode(const char * data, size_t size) {
+    if(size < STATE_LOG_HEADER_SIZE ||
+            memcmp(data, STATE_LOG_MAGIC, STATE_LOG_MAGIC_SIZE) != 0 ||
+            read_u32(data + STATE_LOG_MAGIC_SIZE) < 1 ||
+            read_u32(data + STATE_LOG_MAGIC_SIZE) > STATE_LOG_VERSION)
+        return false;
+
+    bool compressed = read_u32(data + STATE_LOG_MAGIC_SIZE + 4) & STATE_LOG_COMPRESSED;
+    const char * cursor = data + STATE_LOG_HEADER_SIZE;
+    const char * end = data + size;
+    if(!compressed)
+        return decode_records(cursor, end);
+
+    string block;
+    while(cursor != end) {
+        if(end - cursor < 8)
+            return false;
+        uLongf raw_size = read_u32(cursor);
+        uint32_t compressed_size = read_u32(cursor + 4);
+        cursor += 8;
+        if(compressed_size > static_cast<size_t>(end - cursor))
+            return false;
+
+        block.resize(raw_size);
+        uLongf decompressed_size = raw_size;
+        if(uncompress(reinterpret_cast<Bytef*>(&block[0]),
+                      &decompressed_size,
+                      reinterpret_cast<const Bytef*>(cursor),
+                      compressed_size) != Z_OK ||
+                decompressed_size != raw_size)
+            return false;
+        cursor += compressed_size;
+
+        if(!decode_records(block.data(), block.data() + block.size()))
+            return false;
+    }
+    return true;
+}
+
+// ============================================================
+// Function: decode_records(const char*, const char*)
+// Returns:  bool
+//
+// Replays the records between cursor and end, which must be
+// whole uncompressed records from after the header. A log can
+// be decoded a block at a time this way. Returns false on the
+// first malformed record.
+// ============================================================
+bool StateLogDecoder::decode_records(const char * cursor, const char * end) {
+    InputLine line;
+    char text[COMMAND_TEXT_MAX];
+
+    while(cursor != end) {
+        if(is_command_opcode(*cursor)) {
+            if(read_trace_record(cursor, end, line, text) != TraceStatus::Record)
+                return false;
+            messages.command(line.text, line.length);
+            continue;
+        }
+
+        char opcode = *cursor++;
+        uint32_t slot;
+        int pid, burst;
+        switch(opcode) {
+        case 'n': {
+            uint32_t parent;
+            if(!read_slot(cursor, end, slot) || !read_slot(cursor, end, parent))
+                return false;
+            SlotInfo & info = slot_info(slot);
+            info.parent = parent;
+            info.parent_generation = 0;
+            info.children = 0;
+            info.dead = false;
+            if(parent != 0) {
+                SlotInfo & parent_info = slot_info(parent - 1);
+                info.parent_generation = parent_info.generation;
+                ++parent_info.children;
+            }
+            break;
+        }
+        case 'r':
+        case 'w': {
+            if(!read_slot(cursor, end, slot) ||
+                    !read_signed(cursor, end, pid) ||
+                    !read_signed(cursor, end, burst))
+                return false;
+            Entry entry = { slot, slot_info(slot).generation, Process(pid, burst, IDLE_HANDLE) };
+            if(opcode == 'r') {
+                messages.ready_enqueued(entry.process);
+                ready_queue.push_back(entry);
+            } else {
+                int event_id;
+                if(!read_signed(cursor, end, event_id))
+                    return false;
+                entry.process.wait_on(event_id);
+                messages.wait_enqueued(entry.process);
+                wait_queue.push_back(entry);
+            }
+            break;
+        }
+        case 'd': {
+            //The scheduler drops stale handles off the front of the
+            //ready queue on its way to the dispatched process.
+            if(!read_slot(cursor, end, slot))
+                return false;
+            while(!ready_queue.empty()) {
+                bool found = ready_queue.front().slot == slot && is_live(ready_queue.front());
+                ready_queue.pop_front();
+                if(found)
+                    break;
+            }
+            break;
+        }
+        case 'k': {
+            if(!read_slot(cursor, end, slot))
+                return false;
+            for(auto entry = wait_queue.begin(); entry != wait_queue.end(); ++entry) {
+                if(entry->slot == slot && is_live(*entry)) {
+                    wait_queue.erase(entry);
+                    break;
+                }
+            }
+            break;
+        }
+        case 'x':
+            if(!read_slot(cursor, end, slot))
+                return false;
+            slot_info(slot).dead = true;
+            ++dead_roots;
+            break;
+        case 't': {
+            if(!read_slot(cursor, end, slot) ||
+                    !read_signed(cursor, end, pid) ||
+                    !read_signed(cursor, end, burst))
+                return false;
+            messages.terminated(Process(pid, burst, IDLE_HANDLE));
+            release(slot);
+            break;
+        }
+        case 'F':
+            final_state = true;
+            break;
+        case 'S':
+        case 'T':
+        case 'U':
+            if(!decode_state(opcode, cursor, end))
+                return false;
+            break;
+        default:
+            return false;
+        }
+    }
+    return true;
+}
+
+// ============================================================
+// Function: decode_state(char, const char*&, const char*)
+// Returns:  bool
+//
+// Applies an end of tick record to the running process and
+// writes the state, or the final state after an 'F' record.
+// ============================================================
+bool StateLogDecoder::decode_state(char opcode, const char *& cursor, const char * end) {
+    if(opcode == 'T') {
+        running.tick();
+    } else if(opcode == 'S') {
+        uint32_t slot;
+        if(!read_slot(cursor, end, slot))
+            return false;
+        running_idle = slot == 0;
+        if(!running_idle) {
+            int pid, burst, quantum;
+            if(!read_signed(cursor, end, pid) ||
+                    !read_signed(cursor, end, burst) ||
+                    !read_signed(cursor, end, quantum))
+                return false;
+            running = Process(pid, burst, IDLE_HANDLE);
+            running.set_quantum(quantum);
+        }
+    }
+
+    if(2 * releases > ready_queue.size() + wait_queue.size())
+        purge();
+
+    if(final_state) {
+        out.write("Current state of simulation:\n");
+        final_state = false;
+    }
+    write_state(out, *this);
+    return true;
+}
+
+StateLogDecoder::SlotInfo & StateLogDecoder::slot_info(uint32_t slot) {
+    if(slot >= slots.size())
+        slots.resize(slot + 1, SlotInfo{0, 0, 0, 0, false});
+    return slots[slot];
+}
+
+// ============================================================
+// Function: release(uint32_t)
+//
+// Retires a slot once its termination message is seen. A
+// subtree is released parent first, so while the rest of it
+// is on its way the released process's children are counted
+// as orphans and found stale through their parent's
+// generation.
+// ============================================================
+void StateLogDecoder::release(uint32_t slot) {
+    SlotInfo & info = slot_info(slot);
+    if(info.dead) {
+        --dead_roots;
+    } else if(info.parent != 0) {
+        SlotInfo & parent = slot_info(info.parent - 1);
+        if(parent.generation != info.parent_generation)
+            --orphans;
+    }
+
+    if(info.parent != 0) {
+        SlotInfo & parent = slot_info(info.parent - 1);
+        if(parent.generation == info.parent_generation)
+            --parent.children;
+    }
+
+    orphans += info.children;
+    info.children = 0;
+    info.dead = false;
+    ++info.generation;
+    ++releases;
+}
+
+// ============================================================
+// Function: purge()
+//
+// Drops every stale entry from both queues. A stale entry
+// never comes back to life, and purging only once at least
+// half the entries may be stale keeps the cost per release
+// constant while the queues stay short enough to print.
+// ============================================================
+void StateLogDecoder::purge() {
+    auto stale = [this](const Entry & entry) { return !is_live(entry); };
+    ready_queue.erase(remove_if(ready_queue.begin(), ready_queue.end(), stale),
+                      ready_queue.end());
+    wait_queue.erase(remove_if(wait_queue.begin(), wait_queue.end(), stale),
+                     wait_queue.end());
+    releases = 0;
+}
+
+// ============================================================
+// Function: is_live(const Entry&)
+// Returns:  bool
+//
+// Mirrors ProcessTable::get: an entry is live if its slot is
+// still on the same generation and, while a terminated subtree
+// is being released, none of its ancestors are gone.
+// ============================================================
+bool StateLogDecoder::is_live(const Entry & entry) const {
+    const SlotInfo * info = &slots[entry.slot];
+    if(info->generation != entry.generation || info->dead)
+        return false;
+    if(dead_roots == 0 && orphans == 0)
+        return true;
+
+    while(info->parent != 0) {
+        const SlotInfo & parent = slots[info->parent - 1];
+        if(parent.generation != info->parent_generation || parent.dead)
+            return false;
+        info = &parent;
+    }
+    return true;
+}
+
+// ============================================================
+// Function: decode_state_log(const char*, size_t, OutputBuffer&)
+// Returns:  bool
+//
+// Writes the Full text form of a state log to out.
+// ============================================================
+bool decode_state_log(const char * data, size_t size, OutputBuffer & out) {
+    StateLogDecoder decoder(out);
+    return decoder.decode(data, size);
+}
@@ -0,0 +1,205 @@
+// File: state_log.hpp
+// --------------------------------------------------------
+// Class: CS 470                      Instructor: Dr. Hwang
+// Assignment: Process Scheduling     Date Assigned: 22 February 2016
+// Programmer: Evan Higgins           Date Completed: 18 March 2016
+
+#ifndef STATE_LOG_H
+#define STATE_LOG_H
+
+#include <deque>
+#include <string>
+#include <vector>
+#include "output_buffer.hpp"
+#include "process.hpp"
+#include "state_sink.hpp"
+#include "text_sink.hpp"
+
+// ============================================================
+//
+// Binary state log format, version 4. Earlier versions are
+// still read: version 1 had no 'M' records, version 2 no 'O'
+// records and version 3 no 'B' records.
+//
+// A log starts with a 16 byte header:
+//  bytes 0-7    magic "SCHEDLOG"
+//  bytes 8-11   format version, little endian
+//  bytes 12-15  flags, little endian. Bit 0 set if compressed.
+//
+// An uncompressed log continues with the records themselves.
+// A compressed log continues with blocks, each a little endian
+// uint32 uncompressed size, a uint32 compressed size and that
+// many bytes of zlib data. Blocks only ever hold whole records.
+//
+// Records are an opcode byte and varint operands (see
+// binary_trace.hpp). Processes are named by their slot in the
+// process table; pids, bursts, events and quanta are zigzag
+// encoded since bursts and quanta can go negative.
+//  C P B D W O E M I N X R the command of the next tick, stored
+//                         exactly like a binary command trace
+//  'n' slot parent        created, parent is slot + 1 or 0 for
+//                         the idle process
+//  'r' slot pid burst     placed on Ready Queue
+//  'w' slot pid burst ev  placed on Wait Queue
+//  'd' slot               dispatched from the ready queue, which
+//                         is always FIFO (round robin on a
+//                         single CPU only)
+//  'k' slot               woken off the wait queue
+//  'x' slot               subtree terminated
+//  't' slot pid burst     terminated message
+//  'S' slot+1 [pid burst quantum]
+//                         end of tick, with the running process
+//                         in full (slot + 1 is 0 for idle, with
+//                         no further operands)
+//  'T'                    end of tick, the running process is
+//                         the same one with one less burst and
+//                         quantum
+//  'U'                    end of tick, running process unchanged
+//  'F'                    the next end of tick record is the
+//                         final state at X
+//
+// ============================================================
+
+#define STATE_LOG_MAGIC "SCHEDLOG"
+#define STATE_LOG_MAGIC_SIZE 8
+#define STATE_LOG_VERSION 4
+#define STATE_LOG_HEADER_SIZE 16
+#define STATE_LOG_COMPRESSED 1
+
+// ============================================================
+//
+// Writes the state log for a simulation.
+//
+// ============================================================
+class BinaryStateSink : public StateSink
+{
+public:
+    BinaryStateSink(OutputBuffer&, bool);
+    ~BinaryStateSink();
+
+    void command(const char*, size_t);
+    void created(const Process&);
+    void ready_enqueued(const Process&);
+    void wait_enqueued(const Process&);
+    void dispatched(const Process&);
+    void woken(const Process&);
+    void killed(const Process&);
+    void terminated(const Process&);
+    void state(const Scheduler&);
+    void finish(const Scheduler&);
+
+    void flush();
+protected:
+    //For a sink that takes the records itself through
+    //write_records(), about block_limit bytes at a time. No
+    //header is written and nothing is compressed. Such a sink
+    //has to flush() in its own destructor.
+    BinaryStateSink(size_t);
+
+    //Takes the next records. They may be swapped out of
+    //records, which is cleared afterwards either way.
+    virtual void write_records(std::string&);
+private:
+    OutputBuffer * out;
+    bool compress;
+    size_t block_limit;
+
+    //Records not yet written. They are written out once they
+    //grow past block_limit, as one block in a compressed log.
+    std::string block;
+    std::string compressed;
+
+    //The running process as of the last end of tick record.
+    ProcessHandle last_running;
+    int last_burst;
+    int last_quantum;
+
+    void append_slot(const Process&);
+    void append_signed(int);
+    void append_running(const Process&);
+    void end_record();
+};
+
+// ============================================================
+//
+// Regenerates the Full text output from a state log. The
+// decoder mirrors the ready and wait queues from the logged
+// transitions, including which queued processes have gone
+// stale, and prints them with the same formatting the text
+// sinks use. Logs only come from single CPU runs.
+//
+// ============================================================
+class StateLogDecoder
+{
+public:
+    StateLogDecoder(OutputBuffer&);
+
+    bool decode(const char*, size_t);
+    bool decode_records(const char*, const char*);
+
+    unsigned cpu_count() const { return 1; }
+    const Process & running_process(unsigned) const;
+
+    template<typename Visitor>
+    void for_each_ready(unsigned, Visitor visit) const {
+        for(auto & entry : ready_queue)
+            if(is_live(entry))
+                visit(entry.process);
+    }
+
+    template<typename Visitor>
+    void for_each_waiting(Visitor visit) const {
+        for(auto & entry : wait_queue)
+            if(is_live(entry))
+                visit(entry.process);
+    }
+private:
+    struct Entry
+    {
+        uint32_t slot;
+        uint32_t generation;
+        Process process;
+    };
+
+    struct SlotInfo
+    {
+        uint32_t generation;
+        uint32_t parent;        // slot + 1, 0 for idle
+        uint32_t parent_generation;
+        uint32_t children;      // created and not yet terminated
+        bool dead;
+    };
+
+    OutputBuffer & out;
+    FullTextSink messages;
+
+    std::deque<Entry> ready_queue;
+    std::deque<Entry> wait_queue;
+    std::vector<SlotInfo> slots;
+
+    //Killed subtree roots not yet reported as terminated, and
+    //children of released processes not yet terminated
+    //themselves. Ancestors are only checked while either is
+    //nonzero, just like in ProcessTable.
+    size_t dead_roots;
+    size_t orphans;
+
+    //Slots released since the queues were last purged of stale
+    //entries. Each release leaves at most one entry stale.
+    size_t releases;
+
+    Process idle;
+    Process running;
+    bool running_idle;
+    bool final_state;
+
+    SlotInfo & slot_info(uint32_t);
+    void release(uint32_t);
+    bool is_live(const Entry&) const;
+    void purge();
+    bool decode_state(char, const char*&, const char*);
+};
+
+bool decode_state_log(const char*, size_t, OutputBuffer&);
+
+#endif //STATE_LOG_H
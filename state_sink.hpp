@@ -0,0 +1,67 @@
+// File: state_sink.hpp
+// --------------------------------------------------------
+// Class: CS 470                      Instructor: Dr. Hwang
+// Assignment: Process Scheduling     Date Assigned: 22 February 2016
+// Programmer: Evan Higgins           Date Completed: 18 March 2016
+
+#ifndef STATE_SINK_H
+#define STATE_SINK_H
+
+#include <cstddef>
+#include "command.hpp"
+
+class Process;
+class Scheduler;
+
+// ============================================================
+//
+// The Scheduler reports everything that happens during a
+// simulation to a StateSink instead of writing output itself.
+// Each input line produces one command() call, followed by the
+// queue transitions it caused and then one state() call once
+// the tick is over. The initial state is reported with a
+// state() call before the first command and the X command
+// ends the run with finish().
+//
+// ============================================================
+class StateSink
+{
+public:
+    virtual ~StateSink() {}
+
+    virtual void command(const char*, size_t) = 0;
+
+    //Takes the place of command() for a command handed to
+    //Scheduler::submit() rather than read as a line. Sinks that
+    //don't need text override this to skip formatting it.
+    virtual void submitted(const Command & command) {
+        char text[COMMAND_TEXT_MAX];
+        this->command(text, format_command(command, text));
+    }
+
+    //The process was just created as a child of the running
+    //process. It is placed on the ready queue right after.
+    virtual void created(const Process&) = 0;
+
+    virtual void ready_enqueued(const Process&) = 0;
+    virtual void wait_enqueued(const Process&) = 0;
+
+    //The process was taken off the head of the ready queue to run.
+    virtual void dispatched(const Process&) = 0;
+
+    //The process was taken off the wait queue by its event. It is
+    //placed on the ready queue right after.
+    virtual void woken(const Process&) = 0;
+
+    //The process was terminated along with its subtree. From here
+    //on none of them are live, but with a reclaim budget their
+    //terminated() calls may only come on later ticks.
+    virtual void killed(const Process&) = 0;
+
+    virtual void terminated(const Process&) = 0;
+
+    virtual void state(const Scheduler&) = 0;
+    virtual void finish(const Scheduler&) = 0;
+};
+
+#endif //STATE_SINK_H
@@ -0,0 +1,149 @@
+// File: text_sink.cpp
+// --------------------------------------------------------
+// Class: CS 470                      Instructor: Dr. Hwang
+// Assignment: Process Scheduling     Date Assigned: 22 February 2016
+// Programmer: Evan Higgins           Date Completed: 18 March 2016
+
+#include "text_sink.hpp"
+#include "scheduler.hpp"
+
+using namespace std;
+
+// ============================================================
+// Function: parse_output_mode(string, OutputMode&)
+// Returns:  bool
+//
+// Maps an output mode name to its OutputMode. Returns false
+// for an unknown name.
+// ============================================================
+bool parse_output_mode(const string & name, OutputMode & mode) {
+    if(name == "full")
+        mode = OutputMode::Full;
+    else if(name == "delta")
+        mode = OutputMode::Delta;
+    else if(name == "sampled")
+        mode = OutputMode::Sampled;
+    else if(name == "summary")
+        mode = OutputMode::Summary;
+    else if(name == "binary")
+        mode = OutputMode::Binary;
+    else
+        return false;
+    return true;
+}
+
+// ============================================================
+// Function: make_text_sink(OutputMode, OutputBuffer&, long)
+// Returns:  unique_ptr<StateSink>
+//
+// Creates the sink for mode writing to out. sample_interval is
+// only used by OutputMode::Sampled. OutputMode::Binary is not
+// a text mode and gets the Full sink here.
+// ============================================================
+unique_ptr<StateSink> make_text_sink(OutputMode mode,
+                                     OutputBuffer & out,
+                                     long sample_interval) {
+    switch(mode) {
+    case OutputMode::Delta:
+        return unique_ptr<StateSink>(new DeltaTextSink(out));
+    case OutputMode::Sampled:
+        return unique_ptr<StateSink>(new SampledTextSink(out, sample_interval));
+    case OutputMode::Summary:
+        return unique_ptr<StateSink>(new SummaryTextSink(out));
+    case OutputMode::Full:
+    case OutputMode::Binary:
+        break;
+    }
+    return unique_ptr<StateSink>(new FullTextSink(out));
+}
+
+void TextSink::finish(const Scheduler & scheduler) {
+    out.write("Current state of simulation:\n");
+    write_state(out, scheduler);
+}
+
+// ============================================================
+// Function: write_process(OutputBuffer&, const Process&)
+//
+// Writes a process as "PID pid burst", or "PID 0" for the
+// idle process.
+// ============================================================
+void write_process(OutputBuffer & out, const Process & process) {
+    out.write("PID ");
+    out.put_int(process.get_PID());
+    if(!process.is_idle()) {
+        out.put(' ');
+        out.put_int(process.get_remaining_burst());
+    }
+}
+
+void TextSink::write_line(const char * line, size_t length) {
+    out.write(line, length);
+    out.put('\n');
+}
+
+void TextSink::write_message(const Process & process, const char * message) {
+    write_process(out, process);
+    out.write(message);
+}
+
+void FullTextSink::ready_enqueued(const Process & process) {
+    write_message(process, " placed on Ready Queue\n");
+}
+
+void FullTextSink::wait_enqueued(const Process & process) {
+    write_message(process, " placed on Wait Queue\n");
+}
+
+void FullTextSink::terminated(const Process & process) {
+    write_message(process, " terminated\n");
+}
+
+void FullTextSink::state(const Scheduler & scheduler) {
+    write_state(out, scheduler);
+}
+
+void DeltaTextSink::dispatched(const Process & process) {
+    write_message(process, " left Ready Queue\n");
+}
+
+void DeltaTextSink::woken(const Process & process) {
+    write_message(process, " left Wait Queue\n");
+}
+
+void DeltaTextSink::state(const Scheduler & scheduler) {
+    write_running(out, scheduler);
+}
+
+// ============================================================
+// Function: state(const Scheduler&)
+//
+// Writes the tick number and the full state on every
+// interval'th tick, counting the initial state as tick 0. An
+// "I n" line counts as a single tick here since its state is
+// only reported once.
+// ============================================================
+void SampledTextSink::state(const Scheduler & scheduler) {
+    if(interval > 0 && ticks % interval != 0)
+        return;
+
+    out.write("Tick ");
+    out.put_int(ticks);
+    out.put('\n');
+    write_state(out, scheduler);
+}
+
+void SummaryTextSink::finish(const Scheduler & scheduler) {
+    out.write("Commands: ");
+    out.put_int(commands);
+    out.write("\nPlaced on Ready Queue: ");
+    out.put_int(ready_enqueues);
+    out.write("\nPlaced on Wait Queue: ");
+    out.put_int(wait_enqueues);
+    out.write("\nDispatched: ");
+    out.put_int(dispatches);
+    out.write("\nTerminated: ");
+    out.put_int(terminations);
+    out.put('\n');
+    TextSink::finish(scheduler);
+}
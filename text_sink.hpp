@@ -0,0 +1,205 @@
+// File: text_sink.hpp
+// --------------------------------------------------------
+// Class: CS 470                      Instructor: Dr. Hwang
+// Assignment: Process Scheduling     Date Assigned: 22 February 2016
+// Programmer: Evan Higgins           Date Completed: 18 March 2016
+
+#ifndef TEXT_SINK_H
+#define TEXT_SINK_H
+
+#include <memory>
+#include <string>
+#include "output_buffer.hpp"
+#include "process.hpp"
+#include "state_sink.hpp"
+
+// ============================================================
+//
+// Output modes for the text trace:
+//  Full    - every command, every queue transition and the full
+//            state after every tick. This is the format the
+//            files in output/ were recorded in.
+//  Delta   - every command and queue transition, including
+//            processes leaving the queues, but only the running
+//            process after each tick. The queues can be rebuilt
+//            from the transitions.
+//  Sampled - the full state every N ticks and nothing else.
+//  Summary - transition counts and the final state only.
+//  Binary  - a compact event log (see state_log.hpp) that
+//            decodes back to the Full format.
+//
+// Every text mode ends with the full final state at X.
+//
+// ============================================================
+enum class OutputMode
+{
+    Full,
+    Delta,
+    Sampled,
+    Summary,
+    Binary
+};
+
+bool parse_output_mode(const std::string&, OutputMode&);
+
+std::unique_ptr<StateSink> make_text_sink(OutputMode, OutputBuffer&, long);
+
+void write_process(OutputBuffer&, const Process&);
+
+// ============================================================
+// Function: write_running(OutputBuffer&, const State&, unsigned)
+//
+// Writes the process running on cpu and its remaining quantum,
+// led by the CPU if there is more than one. State is the
+// Scheduler, or anything else that can report its running
+// processes and visit its queues the same way.
+// ============================================================
+template<typename State>
+void write_running(OutputBuffer & out, const State & state, unsigned cpu) {
+    if(state.cpu_count() > 1) {
+        out.write("CPU ");
+        out.put_int(cpu);
+        out.write(": ");
+    }
+
+    const Process & running = state.running_process(cpu);
+    write_process(out, running);
+    out.write(" running");
+    if(!running.is_idle()) {
+        out.write(" with ");
+        out.put_int(running.get_remaining_quantum());
+        out.write(" left");
+    }
+    out.put('\n');
+}
+
+// ============================================================
+// Function: write_running(OutputBuffer&, const State&)
+//
+// Writes the process running on every CPU.
+// ============================================================
+template<typename State>
+void write_running(OutputBuffer & out, const State & state) {
+    for(unsigned cpu = 0; cpu < state.cpu_count(); ++cpu)
+        write_running(out, state, cpu);
+}
+
+// ============================================================
+// Function: write_state(OutputBuffer&, const State&)
+//
+// Writes the state of the scheduler. It lists the process
+// running on each CPU with its remaining quantum and all
+// processes on that CPU's ready queue, then all processes on
+// the wait queue.
+// ============================================================
+template<typename State>
+void write_state(OutputBuffer & out, const State & state) {
+    for(unsigned cpu = 0; cpu < state.cpu_count(); ++cpu) {
+        write_running(out, state, cpu);
+
+        out.write("Ready Queue: ");
+        state.for_each_ready(cpu, [&out](const Process & process) {
+                    write_process(out, process);
+                    out.put(' ');
+                });
+        out.put('\n');
+    }
+
+    out.write("Wait Queue: ");
+    state.for_each_waiting([&out](const Process & process) {
+                write_process(out, process);
+                out.put(' ');
+                out.put_int(process.get_waiting_on());
+            });
+
+    out.put('\n');
+}
+
+// ============================================================
+//
+// Shared formatting for the text sinks.
+//
+// ============================================================
+class TextSink : public StateSink
+{
+public:
+    TextSink(OutputBuffer & out) : out(out) {}
+
+    void command(const char*, size_t) {}
+    void created(const Process&) {}
+    void ready_enqueued(const Process&) {}
+    void wait_enqueued(const Process&) {}
+    void dispatched(const Process&) {}
+    void woken(const Process&) {}
+    void killed(const Process&) {}
+    void terminated(const Process&) {}
+    void state(const Scheduler&) {}
+    void finish(const Scheduler&);
+protected:
+    OutputBuffer & out;
+
+    void write_line(const char*, size_t);
+    void write_message(const Process&, const char*);
+};
+
+class FullTextSink : public TextSink
+{
+public:
+    FullTextSink(OutputBuffer & out) : TextSink(out) {}
+
+    void command(const char * line, size_t length) { write_line(line, length); }
+    void ready_enqueued(const Process&);
+    void wait_enqueued(const Process&);
+    void terminated(const Process&);
+    void state(const Scheduler&);
+};
+
+class DeltaTextSink : public FullTextSink
+{
+public:
+    DeltaTextSink(OutputBuffer & out) : FullTextSink(out) {}
+
+    void dispatched(const Process&);
+    void woken(const Process&);
+    void state(const Scheduler&);
+};
+
+class SampledTextSink : public TextSink
+{
+public:
+    SampledTextSink(OutputBuffer & out, long interval) :
+        TextSink(out), interval(interval), ticks(0) {}
+
+    void command(const char*, size_t) { ++ticks; }
+    void state(const Scheduler&);
+private:
+    long interval;
+    long ticks;
+};
+
+class SummaryTextSink : public TextSink
+{
+public:
+    SummaryTextSink(OutputBuffer & out) :
+        TextSink(out),
+        commands(0),
+        ready_enqueues(0),
+        wait_enqueues(0),
+        dispatches(0),
+        terminations(0) {}
+
+    void command(const char*, size_t) { ++commands; }
+    void ready_enqueued(const Process&) { ++ready_enqueues; }
+    void wait_enqueued(const Process&) { ++wait_enqueues; }
+    void dispatched(const Process&) { ++dispatches; }
+    void terminated(const Process&) { ++terminations; }
+    void finish(const Scheduler&);
+private:
+    long commands;
+    long ready_enqueues;
+    long wait_enqueues;
+    long dispatches;
+    long terminations;
+};
+
+#endif //TEXT_SINK_H
@@ -0,0 +1,243 @@
+// File: timer_wheel.cpp
+// --------------------------------------------------------
+// Class: CS 470                      Instructor: Dr. Hwang
+// Assignment: Process Scheduling     Date Assigned: 22 February 2016
+// Programmer: Evan Higgins           Date Completed: 18 March 2016
+
+#include "timer_wheel.hpp"
+
+using namespace std;
+
+TimerWheel::TimerWheel() :
+    now(0),
+    count(0)
+{
+    for(Bucket & bucket : buckets)
+        bucket = Bucket{ NO_TIMER, NO_TIMER };
+    for(uint64_t & bits : occupied)
+        bits = 0;
+}
+
+// ============================================================
+// Function: arm(uint32_t, uint64_t)
+//
+// Sets the timer of slot to expire on tick deadline, replacing
+// any it already had.
+// ============================================================
+void TimerWheel::arm(uint32_t slot, uint64_t deadline) {
+    if(slot >= timers.size())
+        timers.resize(slot + 1, Timer{ NO_TIMER, NO_TIMER, 0, NO_BUCKET });
+    cancel(slot);
+    timers[slot].deadline = deadline;
+    place(slot);
+    ++count;
+}
+
+// ============================================================
+// Function: cancel(uint32_t)
+//
+// Disarms the timer of slot, if it has one.
+// ============================================================
+void TimerWheel::cancel(uint32_t slot) {
+    if(!armed(slot))
+        return;
+    unlink(slot);
+    --count;
+}
+
+// ============================================================
+// Function: next_due()
+// Returns:  uint64_t
+//
+// A tick no later than the next deadline, so nothing can
+// expire before it, or UINT64_MAX with no timers armed. It is
+// the deadline itself unless the timer is still on a level
+// above the first.
+// ============================================================
+uint64_t TimerWheel::next_due() const {
+    if(buckets[DUE_BUCKET].head != NO_TIMER)
+        return now;
+    return next_bucket();
+}
+
+// ============================================================
+// Function: expire(uint64_t, uint32_t&)
+// Returns:  bool
+//
+// Takes the next timer due on or before tick until off the
+// wheel and sets slot to its slot. Returns false once there
+// are none, leaving the wheel at until. until must never go
+// backwards from one call to the next.
+// ============================================================
+bool TimerWheel::expire(uint64_t until, uint32_t & slot) {
+    while(buckets[DUE_BUCKET].head == NO_TIMER) {
+        uint64_t next = next_bucket();
+        if(next > until) {
+            if(until > now)
+                now = until;
+            return false;
+        }
+        now = next;
+        cascade();
+    }
+
+    slot = buckets[DUE_BUCKET].head;
+    unlink(slot);
+    --count;
+    return true;
+}
+
+// ============================================================
+// Function: save(SnapshotWriter&)
+//
+// Writes the current tick and every timer, bucket by bucket.
+// Putting them back in that order puts each back in the same
+// bucket at the same position.
+// ============================================================
+void TimerWheel::save(SnapshotWriter & out) const {
+    out.put(now);
+    out.put(count);
+    for(const Bucket & bucket : buckets) {
+        for(uint32_t slot = bucket.head; slot != NO_TIMER; slot = timers[slot].next) {
+            out.put_index(slot);
+            out.put(timers[slot].deadline);
+        }
+    }
+}
+
+// ============================================================
+// Function: restore(SnapshotReader&, uint32_t)
+// Returns:  bool
+//
+// Replaces every timer with what save() wrote. Returns false
+// if a slot isn't below slots or has two timers.
+// ============================================================
+bool TimerWheel::restore(SnapshotReader & in, uint32_t slots) {
+    *this = TimerWheel();
+    now = in.get();
+
+    size_t timers_saved = in.get_count();
+    for(size_t i = 0; i < timers_saved && in.good(); ++i) {
+        uint32_t slot = in.get_index();
+        uint64_t deadline = in.get();
+        if(slot >= slots || armed(slot))
+            return false;
+        arm(slot, deadline);
+    }
+    return in.good();
+}
+
+// ============================================================
+// Function: place(uint32_t)
+//
+// Puts the timer of slot in the bucket its deadline falls in
+// from the current tick: the lowest level on which the two
+// differ, or the due bucket if it has already come.
+// ============================================================
+void TimerWheel::place(uint32_t slot) {
+    uint64_t deadline = timers[slot].deadline;
+    if(deadline <= now) {
+        link(slot, DUE_BUCKET);
+        return;
+    }
+
+    int level = (63 - __builtin_clzll(deadline ^ now)) / WHEEL_BITS;
+    uint64_t index = (deadline >> (level * WHEEL_BITS)) & (WHEEL_SLOTS - 1);
+    link(slot, static_cast<uint16_t>(level * WHEEL_SLOTS + index));
+}
+
+// ============================================================
+// Function: link(uint32_t, uint16_t)
+//
+// Adds the timer of slot to the back of bucket.
+// ============================================================
+void TimerWheel::link(uint32_t slot, uint16_t bucket) {
+    Timer & timer = timers[slot];
+    Bucket & list = buckets[bucket];
+    timer.bucket = bucket;
+    timer.prev = list.tail;
+    timer.next = NO_TIMER;
+    if(list.tail != NO_TIMER)
+        timers[list.tail].next = slot;
+    else
+        list.head = slot;
+    list.tail = slot;
+
+    if(bucket != DUE_BUCKET)
+        occupied[bucket / WHEEL_SLOTS] |= 1ull << (bucket % WHEEL_SLOTS);
+}
+
+// ============================================================
+// Function: unlink(uint32_t)
+//
+// Takes the timer of slot out of its bucket, leaving it
+// disarmed.
+// ============================================================
+void TimerWheel::unlink(uint32_t slot) {
+    Timer & timer = timers[slot];
+    Bucket & list = buckets[timer.bucket];
+    if(timer.prev != NO_TIMER)
+        timers[timer.prev].next = timer.next;
+    else
+        list.head = timer.next;
+    if(timer.next != NO_TIMER)
+        timers[timer.next].prev = timer.prev;
+    else
+        list.tail = timer.prev;
+
+    if(list.head == NO_TIMER && timer.bucket != DUE_BUCKET)
+        occupied[timer.bucket / WHEEL_SLOTS] &= ~(1ull << (timer.bucket % WHEEL_SLOTS));
+    timer.prev = timer.next = NO_TIMER;
+    timer.bucket = NO_BUCKET;
+}
+
+// ============================================================
+// Function: next_bucket()
+// Returns:  uint64_t
+//
+// The first tick after now at which a bucket in use starts, or
+// UINT64_MAX if none is. Every bucket on a level starts before
+// any bucket in use on the levels above, so the lowest level
+// with one in use has the answer.
+// ============================================================
+uint64_t TimerWheel::next_bucket() const {
+    for(int level = 0; level < WHEEL_LEVELS; ++level) {
+        int shift = level * WHEEL_BITS;
+        int current = (now >> shift) & (WHEEL_SLOTS - 1);
+        if(current == WHEEL_SLOTS - 1)
+            continue;
+        uint64_t later = occupied[level] & (~0ull << (current + 1));
+        if(!later)
+            continue;
+
+        int range = shift + WHEEL_BITS;
+        uint64_t base = range >= 64 ? 0 : now >> range << range;
+        return base + (static_cast<uint64_t>(__builtin_ctzll(later)) << shift);
+    }
+    return UINT64_MAX;
+}
+
+// ============================================================
+// Function: cascade()
+//
+// Brings the wheel to a tick now has just reached: the bucket
+// starting there on each level is emptied onto the levels
+// below, highest level first so a timer can drop several
+// levels at once, and the level 0 bucket for now becomes due.
+// ============================================================
+void TimerWheel::cascade() {
+    for(int level = WHEEL_LEVELS - 1; level >= 0; --level) {
+        int shift = level * WHEEL_BITS;
+        if(shift > 0 && (now & ((1ull << shift) - 1)) != 0)
+            continue;
+
+        uint16_t bucket = level * WHEEL_SLOTS + ((now >> shift) & (WHEEL_SLOTS - 1));
+        uint32_t slot = buckets[bucket].head;
+        while(slot != NO_TIMER) {
+            uint32_t next = timers[slot].next;
+            unlink(slot);
+            place(slot);
+            slot = next;
+        }
+    }
+}
@@ -0,0 +1,98 @@
+// File: timer_wheel.hpp
+// --------------------------------------------------------
+// Class: CS 470                      Instructor: Dr. Hwang
+// Assignment: Process Scheduling     Date Assigned: 22 February 2016
+// Programmer: Evan Higgins           Date Completed: 18 March 2016
+
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <cstdint>
+#include <vector>
+#include "snapshot.hpp"
+
+//Ends a bucket of a TimerWheel.
+const uint32_t NO_TIMER = UINT32_MAX;
+
+//Each level of the wheel has 1 << WHEEL_BITS buckets, and
+//there are enough levels for any uint64_t deadline.
+#define WHEEL_BITS 6
+#define WHEEL_SLOTS (1 << WHEEL_BITS)
+#define WHEEL_LEVELS ((64 + WHEEL_BITS - 1) / WHEEL_BITS)
+
+// ============================================================
+//
+// A hierarchical timing wheel of deadlines in ticks, at most
+// one per process table slot. The links are indexed by slot,
+// the same way a CpuList's are by CPU, so arming and
+// cancelling are O(1) and nothing is allocated once the table
+// has stopped growing.
+//
+// Level 0 has a bucket for each of the next WHEEL_SLOTS ticks.
+// Each level above has a bucket for each of the next
+// WHEEL_SLOTS ranges the size of the whole level below. A timer
+// sits on the lowest level whose range tells its deadline
+// apart from the current tick, and is moved down a level when
+// the current tick reaches the start of its bucket. Every timer
+// moves at most WHEEL_LEVELS times, so expiring is amortized
+// O(1) as well. A bitmap of the buckets in use on each level
+// lets a long stretch without timers be skipped in one step.
+//
+// Timers due on the same tick expire in the order they were
+// armed.
+//
+// ============================================================
+class TimerWheel
+{
+public:
+    TimerWheel();
+
+    bool armed(uint32_t slot) const {
+        return slot < timers.size() && timers[slot].bucket != NO_BUCKET;
+    }
+    size_t size() const { return count; }
+
+    void arm(uint32_t, uint64_t);
+    void cancel(uint32_t);
+
+    uint64_t next_due() const;
+    bool expire(uint64_t, uint32_t&);
+
+    void save(SnapshotWriter&) const;
+    bool restore(SnapshotReader&, uint32_t);
+private:
+    static const uint16_t NO_BUCKET = UINT16_MAX;
+
+    //Timers that are due, in the order they expire.
+    static const uint16_t DUE_BUCKET = WHEEL_LEVELS * WHEEL_SLOTS;
+
+    struct Timer
+    {
+        uint32_t prev;
+        uint32_t next;
+        uint64_t deadline;
+        uint16_t bucket;
+    };
+
+    struct Bucket
+    {
+        uint32_t head;
+        uint32_t tail;
+    };
+
+    std::vector<Timer> timers;
+    Bucket buckets[DUE_BUCKET + 1];
+    uint64_t occupied[WHEEL_LEVELS];
+
+    //The last tick expire() has gone through.
+    uint64_t now;
+    size_t count;
+
+    void place(uint32_t);
+    void link(uint32_t, uint16_t);
+    void unlink(uint32_t);
+    uint64_t next_bucket() const;
+    void cascade();
+};
+
+#endif //TIMER_WHEEL_H
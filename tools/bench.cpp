@@ -0,0 +1,138 @@
+// File: tools/bench.cpp
+// --------------------------------------------------------
+// Times the phases of a simulation separately for each input:
+// reading and parsing it, scheduling it with no output, and
+// writing the Full text output on top of that.
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <sys/resource.h>
+#include "command_buffer.hpp"
+#include "input_reader.hpp"
+#include "output_buffer.hpp"
+#include "scheduler.hpp"
+#include "text_sink.hpp"
+
+using namespace std;
+
+// ============================================================
+//
+// Ignores everything, so a run with it times the scheduling
+// alone.
+//
+// ============================================================
+class NullSink : public StateSink
+{
+public:
+    void command(const char*, size_t) {}
+    void created(const Process&) {}
+    void ready_enqueued(const Process&) {}
+    void wait_enqueued(const Process&) {}
+    void dispatched(const Process&) {}
+    void woken(const Process&) {}
+    void killed(const Process&) {}
+    void terminated(const Process&) {}
+    void state(const Scheduler&) {}
+    void finish(const Scheduler&) {}
+};
+
+void print_usage() {
+    cout << "Execute with: \"bench [--quantum N] [--repeat N] input_file...\"" << endl;
+}
+
+// ============================================================
+// Function: seconds_since(steady_clock::time_point)
+// Returns:  double
+// ============================================================
+double seconds_since(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// ============================================================
+// Function: bench(const string&, int, int)
+// Returns:  bool
+//
+// Runs every phase repeat times on input and reports the best
+// time of each. Returns false if input can't be read.
+// ============================================================
+bool bench(const string & input, int quantum, int repeat) {
+    double parse = 0, schedule = 0, full = 0;
+    size_t commands = 0;
+
+    for(int i = 0; i < repeat; ++i) {
+        auto start = chrono::steady_clock::now();
+        InputReader reader(input);
+        if(!reader.good()) {
+            cerr << "[ERROR]: Input file " << input << " did not open correctly." << endl;
+            return false;
+        }
+        CommandBuffer buffer(reader);
+        double parse_time = seconds_since(start);
+        commands = buffer.size();
+
+        start = chrono::steady_clock::now();
+        NullSink null_sink;
+        BasicScheduler<RoundRobinPolicy> quiet(quantum, null_sink, 1);
+        quiet.run(buffer);
+        double schedule_time = seconds_since(start);
+
+        start = chrono::steady_clock::now();
+        OutputBuffer output("/dev/null");
+        FullTextSink text_sink(output);
+        BasicScheduler<RoundRobinPolicy> printing(quantum, text_sink, 1);
+        printing.run(buffer);
+        output.close();
+        double full_time = seconds_since(start);
+
+        if(i == 0 || parse_time < parse)
+            parse = parse_time;
+        if(i == 0 || schedule_time < schedule)
+            schedule = schedule_time;
+        if(i == 0 || full_time < full)
+            full = full_time;
+    }
+
+    //ru_maxrss is in KiB on Linux. It is the peak for the whole
+    //process, so inputs are best benched one per process.
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    double output = full > schedule ? full - schedule : 0;
+    cout << input << ": " << commands << " commands, quantum " << quantum
+         << ", parse " << parse * 1000 << " ms"
+         << ", schedule " << schedule * 1000 << " ms"
+         << ", output " << output * 1000 << " ms"
+         << ", " << (full > 0 ? commands / full : 0) << " commands/sec"
+         << ", peak RSS " << usage.ru_maxrss << " KiB" << endl;
+    return true;
+}
+
+int main(int argc, char** argv) {
+    int quantum = 5;
+    int repeat = 3;
+
+    int arg = 1;
+    for(; arg < argc && string(argv[arg]).compare(0, 2, "--") == 0; ++arg) {
+        string option = argv[arg];
+        if(option == "--quantum" && arg + 1 < argc) {
+            quantum = atoi(argv[++arg]);
+        } else if(option == "--repeat" && arg + 1 < argc && atoi(argv[arg + 1]) > 0) {
+            repeat = atoi(argv[++arg]);
+        } else {
+            cout << "[ERROR]: Unrecognized option: " << option << endl;
+            print_usage();
+            return 1;
+        }
+    }
+
+    if(arg == argc) {
+        print_usage();
+        return 1;
+    }
+
+    bool ok = true;
+    for(; arg < argc; ++arg)
+        ok = bench(argv[arg], quantum, repeat) && ok;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,45 @@
+// File: tools/state_decode.cpp
+// --------------------------------------------------------
+// Regenerates the Full text output of a simulation from the
+// binary state log written by --output binary (see
+// state_log.hpp).
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include "output_buffer.hpp"
+#include "state_log.hpp"
+
+using namespace std;
+
+void print_usage() {
+    cout << "Execute with: \"state_decode log_file output_file\"" << endl;
+    cout << "output_file may be - to write to stdout." << endl;
+}
+
+int main(int argc, char** argv) {
+    if(argc != 3) {
+        print_usage();
+        return 1;
+    }
+
+    ifstream log_file(argv[1], ios::binary);
+    if(!log_file) {
+        cerr << "[ERROR]: Input file did not open correctly." << endl;
+        return 1;
+    }
+    string log((istreambuf_iterator<char>(log_file)), istreambuf_iterator<char>());
+
+    OutputBuffer output(argv[2]);
+    if(!output.good()) {
+        cerr << "[ERROR]: Output file did not open correctly." << endl;
+        return 1;
+    }
+
+    if(!decode_state_log(log.data(), log.size(), output)) {
+        cerr << "[ERROR]: Not a valid state log." << endl;
+        return 1;
+    }
+    return 0;
+}
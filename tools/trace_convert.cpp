@@ -0,0 +1,146 @@
+// File: tools/trace_convert.cpp
+// --------------------------------------------------------
+// Converts command traces between the text format and the
+// binary format described in binary_trace.hpp, and checks
+// that a text trace survives the round trip unchanged.
+
+#include <iostream>
+#include <string>
+#include "binary_trace.hpp"
+#include "input_reader.hpp"
+#include "output_buffer.hpp"
+
+using namespace std;
+
+void print_usage() {
+    cout << "Execute with:" << endl;
+    cout << "  trace_convert input_file output_file            text to binary" << endl;
+    cout << "  trace_convert --to-text input_file output_file  binary to text" << endl;
+    cout << "  trace_convert --check input_file                text round trip" << endl;
+}
+
+// ============================================================
+// Function: encode(InputReader&, OutputBuffer&)
+//
+// Writes the binary form of a text trace.
+// ============================================================
+int encode(InputReader & input, OutputBuffer & output) {
+    if(input.is_binary()) {
+        cerr << "[ERROR]: Input is already a binary trace." << endl;
+        return 1;
+    }
+
+    string record;
+    append_trace_header(record);
+    output.write(record.data(), record.size());
+
+    const char * line;
+    size_t length;
+    while(input.next_line(line, length)) {
+        record.clear();
+        append_trace_record(record, line, length);
+        output.write(record.data(), record.size());
+    }
+    return 0;
+}
+
+// ============================================================
+// Function: decode(InputReader&, OutputBuffer&)
+//
+// Writes the text form of a binary trace.
+// ============================================================
+int decode(InputReader & input, OutputBuffer & output) {
+    if(!input.is_binary()) {
+        cerr << "[ERROR]: Input is not a binary trace." << endl;
+        return 1;
+    }
+
+    InputLine line;
+    while(input.next(line)) {
+        output.write(line.text, line.length);
+        output.put('\n');
+    }
+    return 0;
+}
+
+// ============================================================
+// Function: check(InputReader&)
+//
+// Encodes a text trace in memory, decodes it again and
+// compares every line with the original.
+// ============================================================
+int check(InputReader & input) {
+    if(input.is_binary()) {
+        cerr << "[ERROR]: --check expects a text trace." << endl;
+        return 1;
+    }
+
+    string encoded;
+    append_trace_header(encoded);
+
+    vector<string> original;
+    const char * text;
+    size_t length;
+    while(input.next_line(text, length)) {
+        original.push_back(string(text, length));
+        append_trace_record(encoded, text, length);
+    }
+
+    const char * cursor = encoded.data() + TRACE_HEADER_SIZE;
+    const char * end = encoded.data() + encoded.size();
+    char command_text[COMMAND_TEXT_MAX];
+    InputLine line;
+    size_t raw_records = 0;
+    for(size_t i = 0; i < original.size(); ++i) {
+        if(read_trace_record(cursor, end, line, command_text) != TraceStatus::Record) {
+            cerr << "[ERROR]: Decoding stopped at line " << i + 1 << endl;
+            return 1;
+        }
+        if(original[i].compare(0, string::npos, line.text, line.length) != 0) {
+            cerr << "[ERROR]: Line " << i + 1 << " differs after round trip" << endl;
+            return 1;
+        }
+        if(!line.decoded)
+            ++raw_records;
+    }
+    if(cursor != end) {
+        cerr << "[ERROR]: Trailing records after round trip" << endl;
+        return 1;
+    }
+
+    cout << "OK: " << original.size() << " lines, "
+         << raw_records << " stored as raw text, "
+         << encoded.size() << " bytes encoded" << endl;
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    string mode;
+    int arg = 1;
+    if(arg < argc && string(argv[arg]).compare(0, 2, "--") == 0)
+        mode = argv[arg++];
+
+    size_t expected = mode == "--check" ? 1 : 2;
+    if((mode != "" && mode != "--to-text" && mode != "--check") ||
+            static_cast<size_t>(argc - arg) != expected) {
+        print_usage();
+        return 1;
+    }
+
+    InputReader input(argv[arg]);
+    if(!input.good()) {
+        cerr << "[ERROR]: Input file did not open correctly." << endl;
+        return 1;
+    }
+
+    if(mode == "--check")
+        return check(input);
+
+    OutputBuffer output(argv[arg + 1]);
+    if(!output.good()) {
+        cerr << "[ERROR]: Output file did not open correctly." << endl;
+        return 1;
+    }
+
+    return mode == "--to-text" ? decode(input, output) : encode(input, output);
+}
@@ -0,0 +1,221 @@
+// File: tools/workload_gen.cpp
+// --------------------------------------------------------
+// Writes synthetic command traces that stress one part of the
+// scheduler each. Every kind takes a size and an optional seed
+// and always writes the same trace for the same arguments.
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#define LONG_BURST 1000000000
+
+void print_usage() {
+    cout << "Execute with: \"workload_gen kind size [seed]\"" << endl;
+    cout << "Kinds:" << endl;
+    cout << "  chain    a chain of size processes, each the child of the last" << endl;
+    cout << "  fanout   size children of a single process" << endl;
+    cout << "  bulk     the same fanout, created in batches by C*" << endl;
+    cout << "  events   size waits and events over a few events with many waiters" << endl;
+    cout << "  barrier  size processes waiting at barriers released by E*" << endl;
+    cout << "  timeouts size processes in timed waits, most of them timing out" << endl;
+    cout << "  destroy  size creates, most of them destroyed again soon after" << endl;
+    cout << "  idle     size commands spread over long I n idle runs" << endl;
+}
+
+// ============================================================
+// Function: chain(int)
+//
+// Each new process is created by the one before it, which then
+// waits so the new one runs next. The whole chain is destroyed
+// at once at the end.
+// ============================================================
+void chain(int size) {
+    cout << "C 1 " << LONG_BURST << "\nI\n";
+    for(int pid = 2; pid <= size; ++pid)
+        cout << "C " << pid << ' ' << LONG_BURST << "\nW 1\n";
+    cout << "D 1\n";
+}
+
+// ============================================================
+// Function: fanout(int, mt19937&)
+//
+// A single long running parent creates size children with
+// short bursts, then the tree is destroyed.
+// ============================================================
+void fanout(int size, mt19937 & random) {
+    uniform_int_distribution<int> burst(1, 50);
+    cout << "C 1 " << LONG_BURST << "\nI\n";
+    for(int pid = 2; pid <= size; ++pid)
+        cout << "C " << pid << ' ' << burst(random) << '\n';
+    cout << "D 1\n";
+}
+
+// ============================================================
+// Function: bulk(int, mt19937&)
+//
+// The tree of fanout, with the children created by C* commands
+// of up to a few thousand at a time.
+// ============================================================
+void bulk(int size, mt19937 & random) {
+    uniform_int_distribution<int> burst(1, 50);
+    uniform_int_distribution<int> width(1, 4096);
+    cout << "C 1 " << LONG_BURST << "\nI\n";
+    for(int pid = 2; pid <= size; ) {
+        int count = min(width(random), size - pid + 1);
+        cout << "C* " << pid << ' ' << count << ' ' << burst(random) << '\n';
+        pid += count;
+    }
+    cout << "D 1\n";
+}
+
+// ============================================================
+// Function: events(int, mt19937&)
+//
+// A pool of long running processes keeps waiting on and
+// signalling a handful of events, so each event has many
+// waiters.
+// ============================================================
+void events(int size, mt19937 & random) {
+    int processes = size / 10 + 1;
+    uniform_int_distribution<int> event(1, 8);
+    uniform_int_distribution<int> coin(0, 1);
+
+    for(int pid = 1; pid <= processes; ++pid)
+        cout << "C " << pid << ' ' << LONG_BURST << '\n';
+    for(int i = 0; i < size; ++i)
+        cout << (coin(random) ? "W " : "E ") << event(random) << '\n';
+}
+
+// ============================================================
+// Function: barrier(int, mt19937&)
+//
+// size long running processes keep waiting at one of four
+// barriers until all of them are waiting. Every round is then
+// released at once, by an E* naming all four barriers or by
+// an E* for each barrier.
+// ============================================================
+void barrier(int size, mt19937 & random) {
+    uniform_int_distribution<int> coin(0, 1);
+    for(int pid = 1; pid <= size; ++pid)
+        cout << "C " << pid << ' ' << LONG_BURST << '\n';
+
+    int waits = 0;
+    while(waits < size * 8) {
+        for(int i = 0; i < size; ++i, ++waits)
+            cout << "W " << i % 4 + 1 << '\n';
+        if(coin(random))
+            cout << "E* 1 2 3 4\n";
+        else
+            cout << "E* 1\nE* 2\nE* 3\nE* 4\n";
+    }
+}
+
+// ============================================================
+// Function: timeouts(int, mt19937&)
+//
+// size long running processes each wait with a timeout of up
+// to a million ticks, so nearly all of them are pending at
+// once. A few events cancel some of the waits early, and long
+// idle runs let the rest time out.
+// ============================================================
+void timeouts(int size, mt19937 & random) {
+    uniform_int_distribution<int> timeout(1, 1000000);
+    uniform_int_distribution<int> event(1, 64);
+    for(int pid = 1; pid <= size; ++pid)
+        cout << "C " << pid << ' ' << LONG_BURST << "\nW " << event(random)
+             << ' ' << timeout(random) << '\n';
+    for(int i = 0; i < 64; ++i)
+        cout << "E " << event(random) << "\nI 20000\n";
+}
+
+// ============================================================
+// Function: destroy(int, mt19937&)
+//
+// Creates size processes and destroys most of them a few
+// commands later, so slots and PIDs are reused constantly.
+// ============================================================
+void destroy(int size, mt19937 & random) {
+    uniform_int_distribution<int> burst(1, 100);
+    vector<int> live;
+    for(int pid = 1; pid <= size; ++pid) {
+        cout << "C " << pid << ' ' << burst(random) << '\n';
+        live.push_back(pid);
+        if(live.size() > 16 || random() % 4 != 0) {
+            size_t victim = random() % live.size();
+            cout << "D " << live[victim] << '\n';
+            live[victim] = live.back();
+            live.pop_back();
+        }
+    }
+}
+
+// ============================================================
+// Function: idle(int, mt19937&)
+//
+// A sparse trace: a few creates, waits and events separated
+// by long idle runs.
+// ============================================================
+void idle(int size, mt19937 & random) {
+    uniform_int_distribution<int> burst(1, 100000);
+    uniform_int_distribution<int> gap(1, 100000);
+    uniform_int_distribution<int> event(1, 4);
+    int pid = 1;
+    for(int i = 0; i < size; ++i) {
+        switch(random() % 4) {
+        case 0:
+            cout << "C " << pid++ << ' ' << burst(random) << '\n';
+            break;
+        case 1:
+            cout << "W " << event(random) << '\n';
+            break;
+        case 2:
+            cout << "E " << event(random) << '\n';
+            break;
+        default:
+            cout << "I " << gap(random) << '\n';
+            break;
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    if(argc < 3 || argc > 4) {
+        print_usage();
+        return 1;
+    }
+
+    string kind = argv[1];
+    int size = atoi(argv[2]);
+    mt19937 random(argc == 4 ? atoi(argv[3]) : 1);
+
+    ios::sync_with_stdio(false);
+    if(kind == "chain")
+        chain(size);
+    else if(kind == "fanout")
+        fanout(size, random);
+    else if(kind == "bulk")
+        bulk(size, random);
+    else if(kind == "events")
+        events(size, random);
+    else if(kind == "barrier")
+        barrier(size, random);
+    else if(kind == "timeouts")
+        timeouts(size, random);
+    else if(kind == "destroy")
+        destroy(size, random);
+    else if(kind == "idle")
+        idle(size, random);
+    else {
+        cout << "[ERROR]: Unknown workload kind: " << kind << endl;
+        print_usage();
+        return 1;
+    }
+    cout << "X\n";
+    return 0;
+}